@@ -6,11 +6,29 @@
 #include <algorithm>
 #include <iomanip>
 #include <cstdint>
+#include <memory>
+#include <functional>
+#include <vector>
 #include "shell/command-line-parser.h"
 #include "imaging/bitmap.h"
 #include "imaging/bmp-format.h"
 #include "imaging/bmp-format.h"
+#include "imaging/png-format.h"
 #include "midi/midi.h"
+#include "midi/note-table.h"
+#include "midi/interval-tree.h"
+#include "midi/tempo-map.h"
+#include "render/frame-export.h"
+#include "render/frame-sequence.h"
+#include "render/raw-sink.h"
+#include "render/y4m-sink.h"
+#include "io/async-file-writer.h"
+#include "io/memory-mapped-file.h"
+#include "logging.h"
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
 
 using namespace midi;
 using namespace std;
@@ -18,41 +36,7 @@ using namespace shell;
 using namespace imaging;
 
 void draw_rectangle(Bitmap& bitmap, const Position& pos, const uint32_t& width, const uint32_t& height, const Color& color){
-	for (uint32_t i = 0; i < width; i++){
-		for (uint32_t j = 0; j < height; j++){
-			bitmap[Position(pos.x + i, pos.y + j)] = color;
-		}
-	}
-}
-
-int getWidth(vector<NOTE> notes){
-	int result = 0;
-	for (NOTE n : notes){
-		if (value(n.start + n.duration) > result){
-			result = value(n.start + n.duration);
-		}
-	}
-	return result;
-}
-
-int getLowestNote(vector<NOTE> notes){
-	int result = 127;
-	for (NOTE n : notes){
-		if (value(n.note_number) < result){
-			result = value(n.note_number);
-		}
-	}
-	return result;
-}
-
-int getHighestNote(vector<NOTE> notes){
-	int result = 0;
-	for (NOTE n : notes){
-		if (value(n.note_number) > result){
-			result = value(n.note_number);
-		}
-	}
-	return result;
+	bitmap.fill_rect(pos.x, pos.y, width, height, color);
 }
 
 int main(int argn, char* argv[]){
@@ -65,12 +49,32 @@ int main(int argn, char* argv[]){
 	uint32_t scale = 10;
 	uint32_t step = 1;
 	uint32_t framewidth = 0;
+	uint32_t workers = 1;
+	uint32_t fps = 30;
+	uint32_t level = DEFAULT_PNG_LEVEL;
+	uint32_t keyframes = 0;
+	uint32_t queue_depth = 4;
+	bool timed = false;
+	bool expand = false;
+	std::string format;
 
 	CommandLineParser parser;
 	parser.add_argument(string("-w"), &framewidth);
 	parser.add_argument(string("-d"), &step);
 	parser.add_argument(string("-s"), &scale);
 	parser.add_argument(string("-h"), &height);
+	parser.add_argument(string("-j"), &workers);
+	parser.add_argument(string("-r"), &fps);
+	parser.add_argument(string("-f"), &format);
+	parser.add_argument(string("-z"), &level);
+	parser.add_argument(string("-k"), &keyframes);
+	parser.add_argument(string("-x"), &expand);
+	parser.add_argument(string("-q"), &queue_depth);
+	// One frame per 1/fps seconds of music instead of one per -d columns; also the y4m frame rate
+	parser.add_argument(string("--fps"), std::function<void(const string&)>([&](const string& argument){
+		fps = std::stoi(argument);
+		timed = true;
+	}));
 	parser.process(argn, argv);
 	if (parser.positional_arguments().size() < 2){
 		exit(EXIT_FAILURE);
@@ -78,39 +82,109 @@ int main(int argn, char* argv[]){
 
 	input_file = parser.positional_arguments()[0];
 	pattern = parser.positional_arguments()[1];
-	std::ifstream input_file_stream(input_file, std::ios_base::binary);
-	vector<NOTE> notes = read_notes(input_file_stream);
-	uint32_t mapwidth = getWidth(notes) / scale;
+
+	if (expand){
+		ifstream in(input_file, ios::binary);
+		render::SequenceReader reader(in);
+		CHECK(render::is_frame_pattern(pattern)) << "Output pattern " << pattern << " has no %d placeholder";
+		bool to_png = pattern.size() >= 4 && pattern.compare(pattern.size() - 4, 4, ".png") == 0;
+		for (unsigned i = 0; reader.next(); ++i){
+			string path = render::frame_path(pattern, i);
+			if (to_png){
+				save_as_png(path, reader.frame(), level);
+			}
+			else {
+				save_as_bmp(path, reader.frame());
+			}
+			cout << "Image: " << i << " expanded" << endl;
+		}
+		return 0;
+	}
+
+	io::MemoryMappedFile input(input_file);
+	NoteTable notes = workers == 1 ? read_notes_columnar(input.data(), input.size()) : NoteTable(read_notes_parallel(input.data(), input.size(), workers));
+	uint32_t mapwidth = value(notes.end()) / scale;
 	if (framewidth == 0){
 		framewidth = mapwidth;
 	}
 
-	int low = getLowestNote(notes);
-	int high = getHighestNote(notes);
-	Bitmap bitmap(mapwidth, 127 * height);
-	for (int i = 0; i <= 127; i++) {
-		for (NOTE n : notes) {
-			if (n.note_number == NoteNumber(i)) {
-				draw_rectangle(bitmap, Position(value(n.start) / scale,
-					(127 - i) * height),
-					value(n.duration) / scale, height,
-					Color(0, 1, 1));
-			}
+	IntervalTree tree(notes);
+	auto create_renderer = [&](){
+		return render::StreamingRenderer(tree, scale, height, notes.lowest_note(), notes.highest_note(), framewidth);
+	};
+	vector<unsigned> positions;
+	if (timed){
+		positions = render::timed_frame_positions(read_tempo_map(input.data(), input.size()), scale, fps, mapwidth, framewidth);
+	}
+	else {
+		unsigned frames = render::frame_count(mapwidth, framewidth, step);
+		for (unsigned i = 0; i != frames; ++i){
+			positions.push_back(i * step);
 		}
 	}
 
-	bitmap = *bitmap.slice(0, height * (127 - high),
-		mapwidth, (high - low + 1) * height).get();
+	bool to_stdout = pattern == "-";
+	bool is_y4m = pattern.size() >= 4 && pattern.compare(pattern.size() - 4, 4, ".y4m") == 0;
+	bool is_png = pattern.size() >= 4 && pattern.compare(pattern.size() - 4, 4, ".png") == 0;
+	bool is_prs = pattern.size() >= 4 && pattern.compare(pattern.size() - 4, 4, ".prs") == 0;
+	if (format.empty()){
+		format = to_stdout || is_y4m ? "y4m" : (is_png ? "png" : (is_prs ? "prs" : "bmp"));
+	}
+
+	unique_ptr<ofstream> file;
+	ostream* stream = &cout;
+	if (to_stdout){
+#ifdef _WIN32
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+	}
+	else if (format != "bmp" && format != "rle8" && format != "png"){
+		file = make_unique<ofstream>(pattern, ios::binary);
+		stream = file.get();
+	}
 
-	for (int i = 0; i <= mapwidth - framewidth; i += step){
-		Bitmap temp = *bitmap.slice(i, 0, framewidth,
-			(high - low + 1) * height).get();
+	// Per-frame files are written on a separate I/O thread unless the queue depth is 0
+	unique_ptr<io::AsyncFileWriter> writer;
+	if (queue_depth > 0){
+		writer = make_unique<io::AsyncFileWriter>(queue_depth);
+	}
 
-		stringstream counter;
-		counter << setfill('0') << setw(5) << (i / step);
-		string out = pattern;
-		imaging::save_as_bmp(out.replace(out.find("%d"), 2, counter.str()), temp);
-		cout << "Image: " << (i / step) << " rendered" << endl;
+	unique_ptr<render::FrameSink> sink;
+	if (format == "bmp" && !to_stdout){
+		sink = make_unique<render::BmpFileSink>(pattern, BmpCompression::None, writer.get());
+	}
+	else if (format == "rle8" && !to_stdout){
+		sink = make_unique<render::BmpFileSink>(pattern, BmpCompression::RLE8, writer.get());
+	}
+	else if (format == "png" && !to_stdout){
+		sink = make_unique<render::PngFileSink>(pattern, level, writer.get());
+	}
+	else if (format == "y4m"){
+		sink = make_unique<render::Y4mSink>(*stream, fps);
+	}
+	else if (format == "prs"){
+		sink = make_unique<render::SequenceSink>(*stream, level, keyframes);
+	}
+	else if (format == "bgra"){
+		sink = make_unique<render::RawSink>(*stream, render::RawSink::Format::BGRA);
+	}
+	else if (format == "rgb"){
+		sink = make_unique<render::RawSink>(*stream, render::RawSink::Format::RGB);
+	}
+	else {
+		exit(EXIT_FAILURE);
+	}
+
+	render::export_frames(positions, workers, create_renderer, *sink, [to_stdout](unsigned i){
+		if (!to_stdout){
+			cout << "Image: " << i << " rendered" << endl;
+		}
+	});
+	sink.reset();
+	stream->flush();
+	if (writer && !writer->finish()){
+		cerr << "Could not write all frames" << endl;
+		exit(EXIT_FAILURE);
 	}
 }
 #endif
\ No newline at end of file
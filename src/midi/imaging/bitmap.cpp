@@ -12,68 +12,118 @@
 
 using namespace imaging;
 
-Bitmap::Bitmap(std::shared_ptr<Grid<Color>> pixels)
+template<typename PIXEL>
+BasicBitmap<PIXEL>::BasicBitmap(std::shared_ptr<Grid<PIXEL>> pixels)
     : m_pixels(pixels)
 {
     // NOP
 }
 
-Bitmap::Bitmap(unsigned width, unsigned height, std::function<Color(const Position&)> initializer)
-    : Bitmap(std::make_shared<ConcreteGrid<Color>>(width, height, initializer))
+template<typename PIXEL>
+BasicBitmap<PIXEL>::BasicBitmap(unsigned width, unsigned height, std::function<PIXEL(const Position&)> initializer)
+    : BasicBitmap(std::make_shared<ConcreteGrid<PIXEL>>(width, height, initializer))
 {
     // NOP
 }
 
-Bitmap::Bitmap(unsigned width, unsigned height)
-    : Bitmap(width, height, [](const Position&) { return colors::black(); })
+template<typename PIXEL>
+BasicBitmap<PIXEL>::BasicBitmap(unsigned width, unsigned height)
+    : BasicBitmap(width, height, [](const Position&) { return PIXEL(colors::black()); })
 {
     // NOP
 }
 
-unsigned Bitmap::width() const
+template<typename PIXEL>
+unsigned BasicBitmap<PIXEL>::width() const
 {
     return m_pixels->width();
 }
 
-unsigned Bitmap::height() const
+template<typename PIXEL>
+unsigned BasicBitmap<PIXEL>::height() const
 {
     return m_pixels->height();
 }
 
-bool Bitmap::is_inside(const Position& p) const
+template<typename PIXEL>
+bool BasicBitmap<PIXEL>::is_inside(const Position& p) const
 {
     return p.x < width() && p.y < height();
 }
 
-Color& Bitmap::operator[](const Position& p)
+template<typename PIXEL>
+PIXEL& BasicBitmap<PIXEL>::operator[](const Position& p)
 {
     assert(is_inside(p));
 
     return (*m_pixels)[p];
 }
 
-const Color& Bitmap::operator[](const Position& p) const
+template<typename PIXEL>
+const PIXEL& BasicBitmap<PIXEL>::operator[](const Position& p) const
 {
     assert(is_inside(p));
 
     return (*m_pixels)[p];
 }
 
-void Bitmap::clear(const Color& Color)
+template<typename PIXEL>
+GridView<PIXEL> BasicBitmap<PIXEL>::view()
 {
-    for_each_position([this, &Color](const Position& p) {
-        (*m_pixels)[p] = Color;
-    });
+    return m_pixels->view();
 }
 
-void Bitmap::for_each_position(std::function<void(const Position&)> callback) const
+template<typename PIXEL>
+GridView<const PIXEL> BasicBitmap<PIXEL>::view() const
+{
+    return static_cast<const Grid<PIXEL>&>(*m_pixels).view();
+}
+
+template<typename PIXEL>
+void BasicBitmap<PIXEL>::clear(const PIXEL& color)
+{
+    auto pixels = view();
+
+    for (unsigned y = 0; y != pixels.height(); ++y)
+    {
+        std::fill(pixels.row(y), pixels.row(y) + pixels.width(), color);
+    }
+}
+
+template<typename PIXEL>
+void BasicBitmap<PIXEL>::fill_rect(int x, int y, int width, int height, const PIXEL& color)
+{
+    int64_t left = std::max<int64_t>(x, 0);
+    int64_t top = std::max<int64_t>(y, 0);
+    int64_t right = std::min<int64_t>(int64_t(x) + width, this->width());
+    int64_t bottom = std::min<int64_t>(int64_t(y) + height, this->height());
+
+    if (left >= right || top >= bottom)
+    {
+        return;
+    }
+
+    auto pixels = view();
+
+    for (int64_t j = top; j != bottom; ++j)
+    {
+        std::fill(pixels.row(unsigned(j)) + left, pixels.row(unsigned(j)) + right, color);
+    }
+}
+
+template<typename PIXEL>
+void BasicBitmap<PIXEL>::for_each_position(std::function<void(const Position&)> callback) const
 {
     m_pixels->for_each_position(callback);
 }
 
-std::shared_ptr<Bitmap> Bitmap::slice(int x, int y, int width, int height) const
+template<typename PIXEL>
+std::shared_ptr<BasicBitmap<PIXEL>> BasicBitmap<PIXEL>::slice(int x, int y, int width, int height) const
 {
     auto sg = subgrid(m_pixels, Position(x, y), width, height);
 
-    return std::shared_ptr<Bitmap>( new Bitmap(sg) );
-}
\ No newline at end of file
+    return std::shared_ptr<BasicBitmap>( new BasicBitmap(sg) );
+}
+
+template class imaging::BasicBitmap<Color>;
+template class imaging::BasicBitmap<PackedColor>;
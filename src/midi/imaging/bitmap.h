@@ -2,6 +2,7 @@
 #define BITMAP_H
 
 #include "imaging/color.h"
+#include "imaging/packed-color.h"
 #include "util/grid.h"
 #include <memory>
 #include <string>
@@ -11,23 +12,26 @@
 namespace imaging
 {
     /// <summary>
-    /// Represents a bitmap, i.e. a 2D grid of colors.
+    /// Represents a bitmap, i.e. a 2D grid of pixels of type <typeparamref name="PIXEL" />.
+    /// Use <see cref="Bitmap" /> for full precision colors and <see cref="PackedBitmap" />
+    /// for 32-bit pixels stored as they are written to a BMP file.
     /// </summary>
-    class Bitmap final
+    template<typename PIXEL>
+    class BasicBitmap final
     {
     public:
-        Bitmap(unsigned width, unsigned height, std::function<Color(const Position&)> initializer);
+        BasicBitmap(unsigned width, unsigned height, std::function<PIXEL(const Position&)> initializer);
 
         /// <summary>
         /// Creates a new bitmap width given <paramref name="width" /> and <paramref name="height" />.
         /// All pixels are initialized to black.
         /// </summary>
-        Bitmap(unsigned width, unsigned height);
+        BasicBitmap(unsigned width, unsigned height);
 
         /// <summary>
         /// Copy constructor.
         /// </summary>
-        Bitmap(const Bitmap&) = default;
+        BasicBitmap(const BasicBitmap&) = default;
 
         /// <summary>
         /// Checks if the given <paramref name="position" /> is inside the bitmap.
@@ -37,12 +41,23 @@ namespace imaging
         /// <summary>
         /// Gives access to the pixel at the given <paramref name="position" />.
         /// </summary>
-        Color& operator [](const Position& position);
+        PIXEL& operator [](const Position& position);
 
         /// <summary>
         /// Gives readonly access to the pixel at the given <paramref name="position" />.
         /// </summary>
-        const Color& operator [](const Position&) const;
+        const PIXEL& operator [](const Position&) const;
+
+        /// <summary>
+        /// Gives direct access to the pixels, row by row, without virtual calls.
+        /// The view is only valid as long as the bitmap (or the bitmap it was sliced from) is alive.
+        /// </summary>
+        GridView<PIXEL> view();
+
+        /// <summary>
+        /// Gives direct readonly access to the pixels, row by row, without virtual calls.
+        /// </summary>
+        GridView<const PIXEL> view() const;
 
         /// <summary>
         /// Returns the width of the bitmap.
@@ -64,15 +79,28 @@ namespace imaging
         /// <summary>
         /// Overwrites all pixels with the given <paramref name="color" />.
         /// </summary>
-        void clear(const Color& color);
+        void clear(const PIXEL& color);
 
-        std::shared_ptr<Bitmap> slice(int x, int y, int width, int height) const;
+        /// <summary>
+        /// Overwrites the pixels of the rectangle with top left corner (<paramref name="x" />, <paramref name="y" />)
+        /// and the given size with <paramref name="color" />, one row span at a time.
+        /// The rectangle is clipped to the bitmap; parts outside it are ignored.
+        /// </summary>
+        void fill_rect(int x, int y, int width, int height, const PIXEL& color);
+
+        std::shared_ptr<BasicBitmap> slice(int x, int y, int width, int height) const;
 
     private:
-        Bitmap(std::shared_ptr<Grid<Color>> pixels);
+        BasicBitmap(std::shared_ptr<Grid<PIXEL>> pixels);
 
-        std::shared_ptr<Grid<Color>> m_pixels;
+        std::shared_ptr<Grid<PIXEL>> m_pixels;
     };
+
+    typedef BasicBitmap<Color> Bitmap;
+    typedef BasicBitmap<PackedColor> PackedBitmap;
+
+    extern template class BasicBitmap<Color>;
+    extern template class BasicBitmap<PackedColor>;
 }
 
 #endif
@@ -6,6 +6,13 @@
 #include <iostream>
 #include <stdlib.h>
 #include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define BMP_FORMAT_SSE2
+#   include <emmintrin.h>
+#endif
 
 
 using namespace imaging;
@@ -64,6 +71,27 @@ namespace
         BITMAP_HEADER_V5 bitmap_header;
     };
 
+    struct BITMAP_HEADER
+    {
+        uint32_t Size;            /* Size of this header in bytes */
+        int32_t  Width;           /* Image width in pixels */
+        int32_t  Height;          /* Image height in pixels */
+        uint16_t Planes;          /* Number of color planes */
+        uint16_t BitsPerPixel;    /* Number of bits per pixel */
+        uint32_t Compression;     /* Compression methods used */
+        uint32_t SizeOfBitmap;    /* Size of bitmap in bytes */
+        int32_t  HorzResolution;  /* Horizontal resolution in pixels per meter */
+        int32_t  VertResolution;  /* Vertical resolution in pixels per meter */
+        uint32_t ColorsUsed;      /* Number of colors in the image */
+        uint32_t ColorsImportant; /* Minimum number of important colors */
+    };
+
+    struct BITMAP_FILE
+    {
+        FILE_HEADER   file_header;
+        BITMAP_HEADER bitmap_header;
+    };
+
     struct ARGB
     {
         uint8_t b;
@@ -90,6 +118,265 @@ namespace
 
         return ARGB{ b, g, r, a };
     }
+
+#ifdef BMP_FORMAT_SSE2
+    /// <summary>
+    /// Converts one color to the 32-bit lanes (b, g, r, a), truncating like to_argb.
+    /// </summary>
+    inline __m128i to_argb_lanes(const Color& c, __m128d scale, __m128i alpha)
+    {
+        __m128i rg = _mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(&c.r), scale));
+        __m128i b = _mm_cvttpd_epi32(_mm_mul_pd(_mm_load_sd(&c.b), scale));
+
+        // (r, g, 0, 0) -> (0, g, r, 0), then b (in the lowest lane, zeros elsewhere) and alpha
+        rg = _mm_shuffle_epi32(rg, _MM_SHUFFLE(3, 0, 1, 2));
+
+        return _mm_or_si128(_mm_or_si128(rg, b), alpha);
+    }
+#endif
+
+    /// <summary>
+    /// Converts <paramref name="count" /> colors to BMP pixels.
+    /// With SSE2, four pixels are converted and stored at once.
+    /// </summary>
+    void to_argb(const Color* colors, ARGB* pixels, unsigned count)
+    {
+        unsigned i = 0;
+
+#ifdef BMP_FORMAT_SSE2
+        const __m128d scale = _mm_set1_pd(255);
+        const __m128i alpha = _mm_setr_epi32(0, 0, 0, 255);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i low = _mm_packs_epi32(to_argb_lanes(colors[i], scale, alpha), to_argb_lanes(colors[i + 1], scale, alpha));
+            __m128i high = _mm_packs_epi32(to_argb_lanes(colors[i + 2], scale, alpha), to_argb_lanes(colors[i + 3], scale, alpha));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i), _mm_packus_epi16(low, high));
+        }
+#endif
+
+        for (; i < count; ++i)
+        {
+            pixels[i] = to_argb(colors[i]);
+        }
+    }
+
+    void write_header(std::ostream& out, unsigned width, unsigned height)
+    {
+        BITMAP_FILE_V5 header;
+        memset(&header, 0, sizeof(header));
+
+        header.file_header.FileType = 0x4D42;
+        header.file_header.FileSize = sizeof(BITMAP_FILE_V5) + 4 * width * height;
+        header.file_header.Reserved1 = 0;
+        header.file_header.Reserved2 = 0;
+        header.file_header.BitmapOffset = sizeof(BITMAP_FILE_V5);
+
+        header.bitmap_header.Size = sizeof(BITMAP_HEADER_V5);
+        header.bitmap_header.Width = width;
+        header.bitmap_header.Height = height;
+        header.bitmap_header.Planes = 1;
+        header.bitmap_header.BitsPerPixel = 32;
+        header.bitmap_header.Compression = 0;
+        header.bitmap_header.SizeOfBitmap = 0;
+        header.bitmap_header.HorzResolution = 3779;
+        header.bitmap_header.VertResolution = 3779;
+        header.bitmap_header.ColorsUsed = 0;
+        header.bitmap_header.ColorsImportant = 0;
+        header.bitmap_header.RedMask = 0x00FF0000;
+        header.bitmap_header.GreenMask = 0x0000FF00;
+        header.bitmap_header.BlueMask = 0x000000FF;
+        header.bitmap_header.AlphaMask = 0xFF000000;
+        header.bitmap_header.CSType = 0x73524742;
+        header.bitmap_header.Intent = 4;
+
+        out.write(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+}
+
+namespace
+{
+    const uint32_t BI_RLE8 = 1;
+
+    uint32_t key_of(const PackedColor& c)
+    {
+        uint32_t result;
+        memcpy(&result, &c, sizeof(result));
+
+        return result;
+    }
+
+    /// <summary>
+    /// Builds a palette for the bitmap, read with its columns rotated left by <paramref name="first_column" />,
+    /// and fills <paramref name="indices" /> with the palette index of every pixel, rows bottom to top.
+    /// Fails if there are more than 256 colors or a color is not opaque.
+    /// </summary>
+    bool index_colors(const PackedBitmap& bitmap, unsigned first_column, std::vector<PackedColor>& palette, std::vector<uint8_t>& indices)
+    {
+        std::unordered_map<uint32_t, uint8_t> lookup;
+        uint32_t last_key = 0;
+        uint8_t last_index = 0;
+        auto pixels = bitmap.view();
+        unsigned width = bitmap.width();
+
+        palette.clear();
+        indices.resize(size_t(width) * bitmap.height());
+        uint8_t* out = indices.data();
+
+        for (int y = bitmap.height() - 1; y >= 0; --y)
+        {
+            const PackedColor* row = pixels.row(y);
+            unsigned x = first_column;
+
+            for (unsigned i = 0; i != width; ++i, x = x + 1 == width ? 0 : x + 1)
+            {
+                const PackedColor& c = row[x];
+                uint32_t key = key_of(c);
+
+                if (palette.empty() || key != last_key)
+                {
+                    auto it = lookup.find(key);
+
+                    if (it == lookup.end())
+                    {
+                        if (palette.size() == 256 || c.a != 255)
+                        {
+                            return false;
+                        }
+
+                        it = lookup.emplace(key, uint8_t(palette.size())).first;
+                        palette.push_back(c);
+                    }
+
+                    last_key = key;
+                    last_index = it->second;
+                }
+
+                *out++ = last_index;
+            }
+        }
+
+        return true;
+    }
+
+    /// <summary>
+    /// Appends one row of palette indices in BI_RLE8 form: runs of equal pixels as (count, index)
+    /// pairs, stretches without repeats of three or more pixels in absolute mode, then end of line.
+    /// </summary>
+    void encode_rle8_row(const uint8_t* row, unsigned width, std::vector<uint8_t>& out)
+    {
+        unsigned x = 0;
+
+        while (x < width)
+        {
+            unsigned run = 1;
+
+            while (x + run < width && run < 255 && row[x + run] == row[x])
+            {
+                ++run;
+            }
+
+            if (run > 1)
+            {
+                out.push_back(uint8_t(run));
+                out.push_back(row[x]);
+                x += run;
+
+                continue;
+            }
+
+            // Literal stretch, up to where the next run of equal pixels starts
+            unsigned end = x + 1;
+
+            while (end < width && end - x < 255 && (end + 1 == width || row[end] != row[end + 1]))
+            {
+                ++end;
+            }
+
+            unsigned length = end - x;
+
+            if (length < 3)
+            {
+                for (; x != end; ++x)
+                {
+                    out.push_back(1);
+                    out.push_back(row[x]);
+                }
+            }
+            else
+            {
+                out.push_back(0);
+                out.push_back(uint8_t(length));
+                out.insert(out.end(), row + x, row + end);
+
+                if (length % 2 != 0)
+                {
+                    out.push_back(0);
+                }
+
+                x = end;
+            }
+        }
+
+        out.push_back(0);
+        out.push_back(0);
+    }
+
+    bool save_as_rle8_bmp(std::ostream& out, const PackedBitmap& bitmap, unsigned first_column)
+    {
+        std::vector<PackedColor> palette;
+        std::vector<uint8_t> indices;
+
+        if (!index_colors(bitmap, first_column, palette, indices))
+        {
+            return false;
+        }
+
+        std::vector<uint8_t> data;
+        data.reserve(indices.size() / 8);
+
+        for (unsigned y = 0; y != bitmap.height(); ++y)
+        {
+            encode_rle8_row(indices.data() + size_t(y) * bitmap.width(), bitmap.width(), data);
+        }
+
+        // End of bitmap
+        data.push_back(0);
+        data.push_back(1);
+
+        uint32_t palette_size = uint32_t(sizeof(ARGB) * palette.size());
+        BITMAP_FILE header;
+        memset(&header, 0, sizeof(header));
+
+        header.file_header.FileType = 0x4D42;
+        header.file_header.FileSize = uint32_t(sizeof(BITMAP_FILE) + palette_size + data.size());
+        header.file_header.BitmapOffset = sizeof(BITMAP_FILE) + palette_size;
+
+        header.bitmap_header.Size = sizeof(BITMAP_HEADER);
+        header.bitmap_header.Width = bitmap.width();
+        header.bitmap_header.Height = bitmap.height();
+        header.bitmap_header.Planes = 1;
+        header.bitmap_header.BitsPerPixel = 8;
+        header.bitmap_header.Compression = BI_RLE8;
+        header.bitmap_header.SizeOfBitmap = uint32_t(data.size());
+        header.bitmap_header.HorzResolution = 3779;
+        header.bitmap_header.VertResolution = 3779;
+        header.bitmap_header.ColorsUsed = uint32_t(palette.size());
+        header.bitmap_header.ColorsImportant = 0;
+
+        out.write(reinterpret_cast<char*>(&header), sizeof(header));
+
+        for (const PackedColor& c : palette)
+        {
+            ARGB entry{ c.b, c.g, c.r, 0 };
+            out.write(reinterpret_cast<char*>(&entry), sizeof(entry));
+        }
+
+        out.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+        return true;
+    }
 }
 
 void imaging::save_as_bmp(const std::string& path, const Bitmap& bitmap)
@@ -100,46 +387,48 @@ void imaging::save_as_bmp(const std::string& path, const Bitmap& bitmap)
 
 void imaging::save_as_bmp(std::ostream& out, const Bitmap& bitmap)
 {
-    BITMAP_FILE_V5 header;
-    memset(&header, 0, sizeof(header));
-
-    header.file_header.FileType = 0x4D42;
-    header.file_header.FileSize = sizeof(BITMAP_FILE_V5) + 4 * bitmap.width() * bitmap.height();
-    header.file_header.Reserved1 = 0;
-    header.file_header.Reserved2 = 0;
-    header.file_header.BitmapOffset = sizeof(BITMAP_FILE_V5);
-
-    header.bitmap_header.Size = sizeof(BITMAP_HEADER_V5);
-    header.bitmap_header.Width = bitmap.width();
-    header.bitmap_header.Height = bitmap.height();
-    header.bitmap_header.Planes = 1;
-    header.bitmap_header.BitsPerPixel = 32;
-    header.bitmap_header.Compression = 0;
-    header.bitmap_header.SizeOfBitmap = 0;
-    header.bitmap_header.HorzResolution = 3779;
-    header.bitmap_header.VertResolution = 3779;
-    header.bitmap_header.ColorsUsed = 0;
-    header.bitmap_header.ColorsImportant = 0;
-    header.bitmap_header.RedMask = 0x00FF0000;
-    header.bitmap_header.GreenMask = 0x0000FF00;
-    header.bitmap_header.BlueMask = 0x000000FF;
-    header.bitmap_header.AlphaMask = 0xFF000000;
-    header.bitmap_header.CSType = 0x73524742;
-    header.bitmap_header.Intent = 4;
-    
-    out.write(reinterpret_cast<char*>(&header), sizeof(header));
+    write_header(out, bitmap.width(), bitmap.height());
 
+    auto pixels = bitmap.view();
     std::unique_ptr<ARGB[]> scanline = std::make_unique<ARGB[]>(bitmap.width());
 
     for (int y = bitmap.height() - 1; y >= 0; --y)
     {
-        for (unsigned x = 0; x < bitmap.width(); ++x)
-        {
-            Position pos(x, y);
+        to_argb(pixels.row(y), scanline.get(), bitmap.width());
+        out.write(reinterpret_cast<char*>(scanline.get()), sizeof(ARGB) * bitmap.width());
+    }
+}
 
-            scanline[x] = to_argb(bitmap[pos]);
-        }
+void imaging::save_as_bmp(const std::string& path, const PackedBitmap& bitmap)
+{
+    std::ofstream out(path, std::ios::binary);
+    save_as_bmp(out, bitmap);
+}
 
-        out.write(reinterpret_cast<char*>(scanline.get()), sizeof(ARGB) * bitmap.width());
+void imaging::save_as_bmp(std::ostream& out, const PackedBitmap& bitmap)
+{
+    save_as_bmp(out, bitmap, 0, BmpCompression::None);
+}
+
+void imaging::save_as_bmp(std::ostream& out, const PackedBitmap& bitmap, unsigned first_column, BmpCompression compression)
+{
+    static_assert(sizeof(PackedColor) == sizeof(ARGB), "PackedColor must match the BMP pixel layout");
+    assert(first_column == 0 || first_column < bitmap.width());
+
+    if (compression == BmpCompression::RLE8 && save_as_rle8_bmp(out, bitmap, first_column))
+    {
+        return;
+    }
+
+    write_header(out, bitmap.width(), bitmap.height());
+
+    auto pixels = bitmap.view();
+
+    for (int y = bitmap.height() - 1; y >= 0; --y)
+    {
+        const char* row = reinterpret_cast<const char*>(pixels.row(y));
+
+        out.write(row + sizeof(PackedColor) * first_column, sizeof(PackedColor) * (bitmap.width() - first_column));
+        out.write(row, sizeof(PackedColor) * first_column);
     }
 }
@@ -6,8 +6,36 @@
 
 namespace imaging
 {
+    enum class BmpCompression
+    {
+        /// <summary>
+        /// 32 bits per pixel, uncompressed.
+        /// </summary>
+        None,
+
+        /// <summary>
+        /// 8-bit palette indices, run-length encoded (BI_RLE8). Piano roll frames, a background
+        /// and a few note colors, shrink by an order of magnitude. Bitmaps with more than 256 colors,
+        /// or with transparent pixels, are written uncompressed instead.
+        /// </summary>
+        RLE8
+    };
+
     void save_as_bmp(const std::string& path, const Bitmap& bitmap);
     void save_as_bmp(std::ostream& out, const Bitmap& bitmap);
+
+    /// <summary>
+    /// Packed pixels are already in BMP layout and are written without conversion.
+    /// </summary>
+    void save_as_bmp(const std::string& path, const PackedBitmap& bitmap);
+    void save_as_bmp(std::ostream& out, const PackedBitmap& bitmap);
+
+    /// <summary>
+    /// Writes <paramref name="bitmap" /> with its columns rotated left by <paramref name="first_column" />:
+    /// each output row is columns [first_column, width) followed by [0, first_column).
+    /// Lets a ring buffer of columns be written as a frame without first copying it into order.
+    /// </summary>
+    void save_as_bmp(std::ostream& out, const PackedBitmap& bitmap, unsigned first_column, BmpCompression compression = BmpCompression::None);
 }
 
 #endif
@@ -0,0 +1,19 @@
+#include "imaging/packed-color.h"
+
+using namespace imaging;
+
+
+bool imaging::operator ==(const PackedColor& c1, const PackedColor& c2)
+{
+    return c1.r == c2.r && c1.g == c2.g && c1.b == c2.b && c1.a == c2.a;
+}
+
+bool imaging::operator !=(const PackedColor& c1, const PackedColor& c2)
+{
+    return !(c1 == c2);
+}
+
+std::ostream& imaging::operator <<(std::ostream& out, const PackedColor& c)
+{
+    return out << "BGRA[" << int(c.b) << "," << int(c.g) << "," << int(c.r) << "," << int(c.a) << "]";
+}
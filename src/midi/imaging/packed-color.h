@@ -0,0 +1,51 @@
+#ifndef PACKED_COLOR_H
+#define PACKED_COLOR_H
+
+#include "imaging/color.h"
+#include <cstdint>
+#include <iostream>
+
+
+namespace imaging
+{
+    /// <summary>
+    /// 8-bit per channel color, laid out as the 32-bit BGRA pixels of a BMP file
+    /// so that scanlines can be written out as they are stored.
+    /// </summary>
+    struct PackedColor final
+    {
+        uint8_t b;
+        uint8_t g;
+        uint8_t r;
+        uint8_t a;
+
+        /// <summary>
+        /// Default constructor. Initializes the color to opaque black.
+        /// </summary>
+        constexpr PackedColor() : PackedColor(0, 0, 0) { }
+
+        constexpr PackedColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255)
+            : b(b), g(g), r(r), a(a) { }
+
+        /// <summary>
+        /// Quantizes each component of <paramref name="c" /> to 8 bits.
+        /// The result is opaque.
+        /// </summary>
+        explicit constexpr PackedColor(const Color& c)
+            : PackedColor(uint8_t(c.r * 255), uint8_t(c.g * 255), uint8_t(c.b * 255)) { }
+
+        Color to_color() const
+        {
+            return Color(r / 255.0, g / 255.0, b / 255.0);
+        }
+    };
+
+    static_assert(sizeof(PackedColor) == 4, "PackedColor must be exactly one 32-bit pixel");
+
+    bool operator ==(const PackedColor&, const PackedColor&);
+    bool operator !=(const PackedColor&, const PackedColor&);
+
+    std::ostream& operator <<(std::ostream&, const PackedColor&);
+}
+
+#endif
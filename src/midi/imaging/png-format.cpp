@@ -0,0 +1,298 @@
+#include "imaging/png-format.h"
+#include "io/deflate.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <stdint.h>
+#include <vector>
+
+
+using namespace imaging;
+
+namespace
+{
+    const unsigned BYTES_PER_PIXEL = 3;
+
+    // IDAT chunks are written whenever this much compressed data has accumulated
+    const size_t IDAT_SIZE = 1 << 16;
+
+    enum Filter : uint8_t
+    {
+        NONE = 0,
+        SUB = 1,
+        UP = 2,
+        AVERAGE = 3,
+        PAETH = 4
+    };
+
+    const uint32_t* crc_table()
+    {
+        static const struct Table
+        {
+            uint32_t entries[256];
+
+            Table()
+            {
+                for (uint32_t n = 0; n != 256; ++n)
+                {
+                    uint32_t c = n;
+
+                    for (int k = 0; k != 8; ++k)
+                    {
+                        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    }
+
+                    entries[n] = c;
+                }
+            }
+        } table;
+
+        return table.entries;
+    }
+
+    uint32_t update_crc(uint32_t crc, const uint8_t* data, size_t size)
+    {
+        const uint32_t* table = crc_table();
+
+        for (size_t i = 0; i != size; ++i)
+        {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+
+        return crc;
+    }
+
+    void put_big_endian(std::vector<uint8_t>& buffer, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            buffer.push_back(uint8_t(value >> shift));
+        }
+    }
+
+    void write_chunk(std::ostream& out, const char* type, const uint8_t* data, size_t size)
+    {
+        std::vector<uint8_t> header;
+        put_big_endian(header, uint32_t(size));
+        header.insert(header.end(), type, type + 4);
+
+        uint32_t crc = update_crc(0xFFFFFFFFu, header.data() + 4, 4);
+        crc = update_crc(crc, data, size) ^ 0xFFFFFFFFu;
+
+        std::vector<uint8_t> footer;
+        put_big_endian(footer, crc);
+
+        out.write(reinterpret_cast<const char*>(header.data()), header.size());
+        out.write(reinterpret_cast<const char*>(data), size);
+        out.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+    }
+
+    uint8_t paeth(uint8_t a, uint8_t b, uint8_t c)
+    {
+        int p = int(a) + int(b) - int(c);
+        int pa = std::abs(p - int(a));
+        int pb = std::abs(p - int(b));
+        int pc = std::abs(p - int(c));
+
+        if (pa <= pb && pa <= pc)
+        {
+            return a;
+        }
+        else if (pb <= pc)
+        {
+            return b;
+        }
+        else
+        {
+            return c;
+        }
+    }
+
+    /// <summary>
+    /// Applies <paramref name="filter" /> to a row of <paramref name="size" /> bytes, given the unfiltered row above it.
+    /// Returns the sum of the filtered bytes taken as signed values, the usual estimate of how well a row will compress.
+    /// </summary>
+    unsigned apply_filter(Filter filter, const uint8_t* row, const uint8_t* above, uint8_t* out, size_t size)
+    {
+        unsigned cost = 0;
+
+        for (size_t i = 0; i != size; ++i)
+        {
+            uint8_t left = i >= BYTES_PER_PIXEL ? row[i - BYTES_PER_PIXEL] : 0;
+            uint8_t upper_left = i >= BYTES_PER_PIXEL ? above[i - BYTES_PER_PIXEL] : 0;
+            uint8_t predicted;
+
+            switch (filter)
+            {
+            case SUB:     predicted = left; break;
+            case UP:      predicted = above[i]; break;
+            case AVERAGE: predicted = uint8_t((unsigned(left) + above[i]) / 2); break;
+            case PAETH:   predicted = paeth(left, above[i], upper_left); break;
+            default:      predicted = 0; break;
+            }
+
+            out[i] = uint8_t(row[i] - predicted);
+            cost += unsigned(std::abs(int(int8_t(out[i]))));
+        }
+
+        return cost;
+    }
+
+    /// <summary>
+    /// Filters rows as they come in and feeds them to the compressor, choosing per row
+    /// the candidate filter with the lowest cost. The candidates depend on the level:
+    /// only None at level 0, None, Sub and Up up to level 3, all five filters above that.
+    /// </summary>
+    class RowFilter final
+    {
+    public:
+        RowFilter(unsigned width, int level, io::Deflater& deflater)
+            : m_size(size_t(width) * BYTES_PER_PIXEL)
+            , m_candidates(level <= 0 ? 1 : (level <= 3 ? 3 : 5))
+            , m_above(m_size, 0)
+            , m_best(m_size + 1)
+            , m_scratch(m_size + 1)
+            , m_deflater(deflater)
+        {
+            // NOP
+        }
+
+        /// <summary>
+        /// Filters and compresses the next row, <paramref name="row" /> holding its RGB bytes.
+        /// </summary>
+        void write(const uint8_t* row)
+        {
+            unsigned best_cost = apply_filter(NONE, row, m_above.data(), m_best.data() + 1, m_size);
+            m_best[0] = NONE;
+
+            for (unsigned filter = 1; filter < m_candidates && best_cost > 0; ++filter)
+            {
+                unsigned cost = apply_filter(Filter(filter), row, m_above.data(), m_scratch.data() + 1, m_size);
+
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    m_scratch[0] = uint8_t(filter);
+                    std::swap(m_best, m_scratch);
+                }
+            }
+
+            m_deflater.write(m_best.data(), m_best.size());
+            std::copy(row, row + m_size, m_above.begin());
+        }
+
+    private:
+        size_t m_size;
+        unsigned m_candidates;
+        std::vector<uint8_t> m_above;
+        std::vector<uint8_t> m_best;
+        std::vector<uint8_t> m_scratch;
+        io::Deflater& m_deflater;
+    };
+
+    /// <summary>
+    /// Writes a PNG file, asking <paramref name="read_row" /> for the RGB bytes of each row, top to bottom.
+    /// </summary>
+    void write_png(std::ostream& out, unsigned width, unsigned height, int level, std::function<void(unsigned y, uint8_t* rgb)> read_row)
+    {
+        const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        out.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+        std::vector<uint8_t> header;
+        put_big_endian(header, width);
+        put_big_endian(header, height);
+        header.push_back(8);    // Bits per channel
+        header.push_back(2);    // Color type: RGB
+        header.push_back(0);    // Compression method: deflate
+        header.push_back(0);    // Filter method: adaptive
+        header.push_back(0);    // No interlacing
+        write_chunk(out, "IHDR", header.data(), header.size());
+
+        std::vector<uint8_t> idat;
+        io::Deflater deflater(level, [&](const uint8_t* data, size_t size) {
+            idat.insert(idat.end(), data, data + size);
+
+            if (idat.size() >= IDAT_SIZE)
+            {
+                write_chunk(out, "IDAT", idat.data(), idat.size());
+                idat.clear();
+            }
+        });
+
+        RowFilter filter(width, level, deflater);
+        std::vector<uint8_t> row(size_t(width) * BYTES_PER_PIXEL);
+
+        for (unsigned y = 0; y != height; ++y)
+        {
+            read_row(y, row.data());
+            filter.write(row.data());
+        }
+
+        deflater.finish();
+        write_chunk(out, "IDAT", idat.data(), idat.size());
+        write_chunk(out, "IEND", nullptr, 0);
+    }
+
+    void to_rgb(const PackedColor* pixels, uint8_t* rgb, unsigned count)
+    {
+        for (unsigned i = 0; i != count; ++i)
+        {
+            *rgb++ = pixels[i].r;
+            *rgb++ = pixels[i].g;
+            *rgb++ = pixels[i].b;
+        }
+    }
+}
+
+void imaging::save_as_png(const std::string& path, const Bitmap& bitmap, int level)
+{
+    std::ofstream out(path, std::ios::binary);
+    save_as_png(out, bitmap, level);
+}
+
+void imaging::save_as_png(std::ostream& out, const Bitmap& bitmap, int level)
+{
+    auto pixels = bitmap.view();
+
+    write_png(out, bitmap.width(), bitmap.height(), level, [&pixels](unsigned y, uint8_t* rgb) {
+        const Color* row = pixels.row(y);
+
+        for (unsigned x = 0; x != pixels.width(); ++x)
+        {
+            PackedColor c(row[x]);
+
+            *rgb++ = c.r;
+            *rgb++ = c.g;
+            *rgb++ = c.b;
+        }
+    });
+}
+
+void imaging::save_as_png(const std::string& path, const PackedBitmap& bitmap, int level)
+{
+    std::ofstream out(path, std::ios::binary);
+    save_as_png(out, bitmap, level);
+}
+
+void imaging::save_as_png(std::ostream& out, const PackedBitmap& bitmap, int level)
+{
+    save_as_png(out, bitmap, 0, level);
+}
+
+void imaging::save_as_png(std::ostream& out, const PackedBitmap& bitmap, unsigned first_column, int level)
+{
+    assert(first_column == 0 || first_column < bitmap.width());
+
+    auto pixels = bitmap.view();
+    unsigned width = bitmap.width();
+
+    write_png(out, width, bitmap.height(), level, [&pixels, first_column, width](unsigned y, uint8_t* rgb) {
+        const PackedColor* row = pixels.row(y);
+
+        to_rgb(row + first_column, rgb, width - first_column);
+        to_rgb(row, rgb + BYTES_PER_PIXEL * (width - first_column), first_column);
+    });
+}
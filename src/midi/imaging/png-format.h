@@ -0,0 +1,35 @@
+#ifndef PNG_FORMAT_H
+#define PNG_FORMAT_H
+
+#include "imaging/bitmap.h"
+
+
+namespace imaging
+{
+    /// <summary>
+    /// Compression level used when none is given: a balance between speed and size.
+    /// </summary>
+    const int DEFAULT_PNG_LEVEL = 6;
+
+    /// <summary>
+    /// Writes <paramref name="bitmap" /> as an 8-bit RGB PNG file. Alpha is dropped.
+    ///
+    /// <paramref name="level" /> ranges from 0 to 9 and trades speed for size.
+    /// Level 0 stores the pixels uncompressed and unfiltered; higher levels pick a filter per row
+    /// from more candidates and search longer for repeated byte sequences.
+    /// Rows are filtered and compressed as they are produced, so no copy of the whole image is made.
+    /// </summary>
+    void save_as_png(const std::string& path, const Bitmap& bitmap, int level = DEFAULT_PNG_LEVEL);
+    void save_as_png(std::ostream& out, const Bitmap& bitmap, int level = DEFAULT_PNG_LEVEL);
+
+    void save_as_png(const std::string& path, const PackedBitmap& bitmap, int level = DEFAULT_PNG_LEVEL);
+    void save_as_png(std::ostream& out, const PackedBitmap& bitmap, int level = DEFAULT_PNG_LEVEL);
+
+    /// <summary>
+    /// Writes <paramref name="bitmap" /> with its columns rotated left by <paramref name="first_column" />,
+    /// like the corresponding save_as_bmp overload.
+    /// </summary>
+    void save_as_png(std::ostream& out, const PackedBitmap& bitmap, unsigned first_column, int level);
+}
+
+#endif
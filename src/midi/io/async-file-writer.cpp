@@ -0,0 +1,78 @@
+#include "async-file-writer.h"
+#include "logging.h"
+#include <fstream>
+
+namespace {
+	bool write_to_disk(const std::string& path, const std::string& contents) {
+		std::ofstream out(path, std::ios::binary);
+		out.write(contents.data(), contents.size());
+		out.close();
+
+		return bool(out);
+	}
+}
+
+io::AsyncFileWriter::AsyncFileWriter(size_t depth)
+	: AsyncFileWriter(depth, write_to_disk) {
+}
+
+io::AsyncFileWriter::AsyncFileWriter(size_t depth, Output output)
+	: m_depth(depth), m_output(output), m_closing(false), m_failed(false) {
+	CHECK(depth > 0) << "Queue depth must be at least 1";
+
+	// Started last, once every member it uses is initialized
+	m_thread = std::thread(&AsyncFileWriter::run, this);
+}
+
+io::AsyncFileWriter::~AsyncFileWriter() {
+	finish();
+}
+
+void io::AsyncFileWriter::write(const std::string& path, std::string contents) {
+	std::unique_lock<std::mutex> lock(m_lock);
+	CHECK(!m_closing) << "Write after finish";
+
+	m_not_full.wait(lock, [this]() { return m_queue.size() < m_depth; });
+	m_queue.push_back(File{ path, std::move(contents) });
+	m_not_empty.notify_one();
+}
+
+bool io::AsyncFileWriter::finish() {
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_closing = true;
+	}
+
+	m_not_empty.notify_one();
+
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
+
+	return !m_failed;
+}
+
+void io::AsyncFileWriter::run() {
+	while (true) {
+		File file;
+
+		{
+			std::unique_lock<std::mutex> lock(m_lock);
+			m_not_empty.wait(lock, [this]() { return !m_queue.empty() || m_closing; });
+
+			if (m_queue.empty()) {
+				return;
+			}
+
+			file = std::move(m_queue.front());
+			m_queue.pop_front();
+		}
+
+		m_not_full.notify_one();
+
+		if (!m_output(file.path, file.contents)) {
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_failed = true;
+		}
+	}
+}
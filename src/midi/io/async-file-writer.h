@@ -0,0 +1,76 @@
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace io {
+	/// <summary>
+	/// Writes whole files on a dedicated I/O thread, so that whoever produces their contents
+	/// can go on with the next one instead of waiting for the disk.
+	///
+	/// Buffers are handed over through a bounded queue: at most <paramref name="depth" /> of them wait
+	/// to be written, besides the one being written. A depth of 1 amounts to double buffering.
+	/// When the queue is full, <see cref="write" /> blocks until the I/O thread catches up, which
+	/// bounds the memory held by encoded but unwritten files.
+	/// </summary>
+	class AsyncFileWriter final {
+	public:
+		/// <summary>
+		/// Stores <paramref name="contents" /> under <paramref name="path" />; returns false on failure.
+		/// </summary>
+		typedef std::function<bool(const std::string& path, const std::string& contents)> Output;
+
+		explicit AsyncFileWriter(size_t depth);
+
+		/// <summary>
+		/// Hands every file to <paramref name="output" /> on the I/O thread instead of writing it to disk.
+		/// </summary>
+		AsyncFileWriter(size_t depth, Output output);
+
+		/// <summary>
+		/// Waits for all queued files to be written.
+		/// </summary>
+		~AsyncFileWriter();
+
+		AsyncFileWriter(const AsyncFileWriter&) = delete;
+		AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+		/// <summary>
+		/// Queues <paramref name="contents" /> to be written to <paramref name="path" />, replacing any existing file.
+		/// Blocks while the queue is full. May be called from several threads at once.
+		/// </summary>
+		void write(const std::string& path, std::string contents);
+
+		/// <summary>
+		/// Waits for all queued files to be written and stops the I/O thread; no more writes are allowed afterwards.
+		/// Returns false if any file could not be written.
+		/// </summary>
+		bool finish();
+
+		size_t depth() const { return m_depth; }
+
+	private:
+		struct File {
+			std::string path;
+			std::string contents;
+		};
+
+		void run();
+
+		size_t m_depth;
+		Output m_output;
+		std::deque<File> m_queue;
+		std::mutex m_lock;
+		std::condition_variable m_not_full;
+		std::condition_variable m_not_empty;
+		bool m_closing;
+		bool m_failed;
+		std::thread m_thread;
+	};
+}
+#endif
@@ -0,0 +1,78 @@
+#ifndef BYTE_CURSOR_H
+#define BYTE_CURSOR_H
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "byte-span.h"
+#include "logging.h"
+
+namespace io {
+	/// <summary>
+	/// Reads from a contiguous, caller-owned block of bytes (e.g. a memory-mapped file).
+	/// Offers the same operations as the std::istream overloads in read.h so that
+	/// parsing code can be written once for both sources.
+	/// </summary>
+	struct ByteCursor {
+		const uint8_t* current;
+		const uint8_t* end;
+
+		ByteCursor(const uint8_t* data, size_t size) : current(data), end(data + size) {};
+
+		size_t remaining() const { return size_t(end - current); }
+
+		bool at_end() const { return current == end; }
+
+		void skip(size_t n) {
+			CHECK(n <= remaining()) << "Read past end of buffer";
+			current += n;
+		}
+
+		/// <summary>
+		/// Mirrors std::istream::putback: steps back over the last byte read.
+		/// </summary>
+		void putback(uint8_t) {
+			--current;
+		}
+	};
+
+	template<typename T>
+	void read_to(ByteCursor& in, T* buffer, size_t n) {
+		size_t bytes = sizeof(T) * n;
+		CHECK(bytes <= in.remaining()) << "Read past end of buffer";
+		std::memcpy(buffer, in.current, bytes);
+		in.current += bytes;
+	}
+
+	template<typename T>
+	void read_to(ByteCursor& in, T* buffer) {
+		read_to(in, buffer, 1);
+	}
+
+	template<typename T, typename std::enable_if<std::is_fundamental<T>::value, T>::type * = nullptr>
+	T read(ByteCursor& in) {
+		T result;
+		read_to(in, &result);
+		return result;
+	}
+
+	template<typename T>
+	std::unique_ptr<T[]> read_array(ByteCursor& in, size_t n) {
+		std::unique_ptr<T[]> result = std::make_unique<T[]>(n);
+		read_to(in, result.get(), n);
+		return result;
+	}
+
+	/// <summary>
+	/// Returns the next <paramref name="n" /> bytes without copying them; the span points into the cursor's buffer.
+	/// The scratch buffer is unused; it is only there to match the std::istream overload in read.h.
+	/// </summary>
+	inline ByteSpan read_span(ByteCursor& in, size_t n, std::vector<uint8_t>& /*scratch*/) {
+		CHECK(n <= in.remaining()) << "Read past end of buffer";
+		ByteSpan result(in.current, n);
+		in.current += n;
+		return result;
+	}
+}
+#endif
@@ -0,0 +1,35 @@
+#ifndef BYTE_SPAN_H
+#define BYTE_SPAN_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace io {
+	/// <summary>
+	/// Non-owning view of <see cref="size" /> bytes starting at <see cref="data" />.
+	/// Only valid as long as whoever owns the bytes keeps them alive and unchanged.
+	/// </summary>
+	struct ByteSpan {
+		const uint8_t* data;
+		size_t size;
+
+		ByteSpan() : data(nullptr), size(0) {};
+		ByteSpan(const uint8_t* data, size_t size) : data(data), size(size) {};
+
+		const uint8_t& operator [](size_t index) const { return data[index]; }
+
+		const uint8_t* begin() const { return data; }
+		const uint8_t* end() const { return data + size; }
+
+		/// <summary>
+		/// Copies the bytes into a newly allocated array.
+		/// </summary>
+		std::unique_ptr<uint8_t[]> copy() const {
+			std::unique_ptr<uint8_t[]> result = std::make_unique<uint8_t[]>(size);
+			std::copy(begin(), end(), result.get());
+			return result;
+		}
+	};
+}
+#endif
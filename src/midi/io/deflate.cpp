@@ -0,0 +1,351 @@
+#include "deflate.h"
+#include "logging.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	// DEFLATE can refer back at most this far; the window keeps up to twice as much before sliding.
+	const size_t WINDOW_SIZE = 32768;
+	const size_t WINDOW_MASK = WINDOW_SIZE - 1;
+
+	const unsigned MIN_MATCH = 3;
+	const unsigned MAX_MATCH = 258;
+
+	const unsigned HASH_BITS = 15;
+	const size_t HASH_SIZE = size_t(1) << HASH_BITS;
+
+	// Input is compressed, and a block emitted, whenever this much has accumulated.
+	const size_t BLOCK_SIZE = 1 << 16;
+
+	const size_t MAX_STORED = 65535;
+
+	const unsigned END_OF_BLOCK = 256;
+
+	// Hash chain lengths per level; 0 means the input is only stored.
+	const unsigned MAX_CHAIN[] = { 0, 4, 8, 16, 32, 64, 128, 256, 1024, 4096 };
+
+	const uint16_t LENGTH_BASE[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8_t LENGTH_EXTRA[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16_t DISTANCE_BASE[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8_t DISTANCE_EXTRA[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	uint32_t reverse_bits(uint32_t code, unsigned length) {
+		uint32_t result = 0;
+
+		for (unsigned i = 0; i != length; ++i) {
+			result = (result << 1) | ((code >> i) & 1);
+		}
+
+		return result;
+	}
+
+	// Fixed literal/length code (RFC 1951, 3.2.6), bit-reversed since Huffman codes are sent most significant bit first
+	struct FixedCode {
+		uint16_t bits;
+		uint8_t length;
+	};
+
+	const FixedCode* fixed_literal_codes() {
+		static const struct Table {
+			FixedCode codes[288];
+
+			Table() {
+				for (unsigned symbol = 0; symbol != 288; ++symbol) {
+					uint32_t code;
+					unsigned length;
+
+					if (symbol < 144) { code = 0x30 + symbol; length = 8; }
+					else if (symbol < 256) { code = 0x190 + symbol - 144; length = 9; }
+					else if (symbol < 280) { code = symbol - 256; length = 7; }
+					else { code = 0xC0 + symbol - 280; length = 8; }
+
+					codes[symbol] = FixedCode{ uint16_t(reverse_bits(code, length)), uint8_t(length) };
+				}
+			}
+		} table;
+
+		return table.codes;
+	}
+
+	// Maps a match length in [3, 258] to its index in LENGTH_BASE
+	const uint8_t* length_codes() {
+		static const struct Table {
+			uint8_t codes[MAX_MATCH + 1];
+
+			Table() {
+				unsigned code = 0;
+
+				for (unsigned length = MIN_MATCH; length <= MAX_MATCH; ++length) {
+					while (code + 1 < sizeof(LENGTH_BASE) / sizeof(LENGTH_BASE[0]) && LENGTH_BASE[code + 1] <= length) {
+						++code;
+					}
+
+					codes[length] = uint8_t(code);
+				}
+			}
+		} table;
+
+		return table.codes;
+	}
+
+	unsigned distance_code(size_t distance) {
+		const uint16_t* end = DISTANCE_BASE + sizeof(DISTANCE_BASE) / sizeof(DISTANCE_BASE[0]);
+
+		return unsigned(std::upper_bound(DISTANCE_BASE, end, distance) - DISTANCE_BASE) - 1;
+	}
+
+	uint32_t hash(const uint8_t* p) {
+		uint32_t key = uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16);
+
+		return (key * 2654435761u) >> (32 - HASH_BITS);
+	}
+}
+
+uint32_t io::adler32(uint32_t adler, const uint8_t* data, size_t size) {
+	// Largest number of bytes before b can overflow 32 bits and has to be reduced
+	const size_t NMAX = 5552;
+	const uint32_t BASE = 65521;
+
+	uint32_t a = adler & 0xFFFF;
+	uint32_t b = adler >> 16;
+
+	while (size > 0) {
+		size_t n = std::min(size, NMAX);
+		size -= n;
+
+		while (n-- > 0) {
+			a += *data++;
+			b += a;
+		}
+
+		a %= BASE;
+		b %= BASE;
+	}
+
+	return (b << 16) | a;
+}
+
+io::Deflater::Deflater(int level, Output output)
+	: m_level(std::max(0, std::min(level, 9))), m_max_chain(MAX_CHAIN[m_level]), m_output(output)
+	, m_position(0), m_head(HASH_SIZE, -1), m_previous(WINDOW_SIZE, -1)
+	, m_adler(1), m_bit_buffer(0), m_bit_count(0), m_finished(false) {
+	// zlib header: deflate with a 32K window, the level hint, and a check value making it a multiple of 31
+	uint32_t method = 0x78;
+	uint32_t hint = m_level <= 1 ? 0 : (m_level <= 5 ? 1 : (m_level == 6 ? 2 : 3));
+	uint32_t flags = hint << 6;
+	flags += 31 - (method * 256 + flags) % 31;
+
+	m_pending.push_back(uint8_t(method));
+	m_pending.push_back(uint8_t(flags));
+}
+
+void io::Deflater::write(const uint8_t* data, size_t size) {
+	CHECK(!m_finished) << "Write after finish";
+
+	m_adler = adler32(m_adler, data, size);
+	m_window.insert(m_window.end(), data, data + size);
+
+	if (m_window.size() - m_position >= BLOCK_SIZE + MAX_MATCH) {
+		compress(false);
+	}
+}
+
+void io::Deflater::finish() {
+	CHECK(!m_finished) << "Deflater finished twice";
+
+	compress(true);
+	align();
+
+	for (int shift = 24; shift >= 0; shift -= 8) {
+		put_bits((m_adler >> shift) & 0xFF, 8);
+	}
+
+	flush_bytes();
+	m_finished = true;
+}
+
+void io::Deflater::compress(bool final) {
+	if (m_level == 0) {
+		store(final);
+		return;
+	}
+
+	// Unless this is the last block, keep enough input back that every match can reach its full length
+	size_t end = final ? m_window.size() : m_window.size() - MAX_MATCH;
+
+	if (!final && m_position >= end) {
+		return;
+	}
+
+	put_bits(final ? 1 : 0, 1);
+	put_bits(1, 2);
+
+	while (m_position < end) {
+		size_t distance;
+		unsigned length = longest_match(m_position, &distance);
+
+		if (length >= MIN_MATCH) {
+			put_match(length, distance);
+
+			for (unsigned i = 0; i != length; ++i) {
+				insert(m_position + i);
+			}
+
+			m_position += length;
+		}
+		else {
+			put_literal(m_window[m_position]);
+			insert(m_position);
+			++m_position;
+		}
+	}
+
+	put_literal(END_OF_BLOCK);
+	flush_bytes();
+	slide();
+}
+
+void io::Deflater::store(bool final) {
+	size_t remaining = m_window.size() - m_position;
+
+	if (!final && remaining == 0) {
+		return;
+	}
+
+	do {
+		size_t size = std::min(remaining, MAX_STORED);
+		remaining -= size;
+
+		put_bits(final && remaining == 0 ? 1 : 0, 1);
+		put_bits(0, 2);
+		align();
+		put_bits(uint32_t(size), 16);
+		put_bits(uint32_t(~size & 0xFFFF), 16);
+
+		m_pending.insert(m_pending.end(), m_window.data() + m_position, m_window.data() + m_position + size);
+		m_position += size;
+		flush_bytes();
+	} while (remaining > 0);
+
+	// Stored blocks never refer back, so no history needs to be kept
+	m_window.clear();
+	m_position = 0;
+}
+
+void io::Deflater::slide() {
+	if (m_position <= 2 * WINDOW_SIZE) {
+		return;
+	}
+
+	// Shifting by a multiple of the window size keeps the position & WINDOW_MASK indexing of m_previous intact
+	size_t shift = (m_position - WINDOW_SIZE) & ~WINDOW_MASK;
+
+	m_window.erase(m_window.begin(), m_window.begin() + shift);
+	m_position -= shift;
+
+	auto rebase = [shift](int32_t& entry) {
+		entry = entry >= int32_t(shift) ? entry - int32_t(shift) : -1;
+	};
+	std::for_each(m_head.begin(), m_head.end(), rebase);
+	std::for_each(m_previous.begin(), m_previous.end(), rebase);
+}
+
+void io::Deflater::insert(size_t position) {
+	if (position + MIN_MATCH > m_window.size()) {
+		return;
+	}
+
+	uint32_t h = hash(m_window.data() + position);
+	m_previous[position & WINDOW_MASK] = m_head[h];
+	m_head[h] = int32_t(position);
+}
+
+unsigned io::Deflater::longest_match(size_t position, size_t* distance) const {
+	if (position + MIN_MATCH > m_window.size()) {
+		return 0;
+	}
+
+	const uint8_t* data = m_window.data();
+	const uint8_t* current = data + position;
+	unsigned limit = unsigned(std::min<size_t>(MAX_MATCH, m_window.size() - position));
+	unsigned best = 0;
+	int32_t candidate = m_head[hash(current)];
+
+	for (unsigned chain = m_max_chain; candidate >= 0 && chain > 0; --chain) {
+		size_t start = size_t(candidate);
+
+		if (start >= position || position - start > WINDOW_SIZE) {
+			break;
+		}
+
+		const uint8_t* previous = data + start;
+
+		if (previous[best] == current[best]) {
+			unsigned length = 0;
+
+			while (length < limit && previous[length] == current[length]) {
+				++length;
+			}
+
+			if (length > best) {
+				best = length;
+				*distance = position - start;
+
+				if (best == limit) {
+					break;
+				}
+			}
+		}
+
+		// Entries are overwritten once the window wraps; a link that does not lead backwards is stale
+		int32_t next = m_previous[start & WINDOW_MASK];
+
+		if (next >= candidate) {
+			break;
+		}
+
+		candidate = next;
+	}
+
+	return best;
+}
+
+void io::Deflater::put_bits(uint32_t bits, unsigned count) {
+	m_bit_buffer |= uint64_t(bits) << m_bit_count;
+	m_bit_count += count;
+
+	while (m_bit_count >= 8) {
+		m_pending.push_back(uint8_t(m_bit_buffer));
+		m_bit_buffer >>= 8;
+		m_bit_count -= 8;
+	}
+}
+
+void io::Deflater::put_literal(unsigned symbol) {
+	const FixedCode& code = fixed_literal_codes()[symbol];
+
+	put_bits(code.bits, code.length);
+}
+
+void io::Deflater::put_match(unsigned length, size_t distance) {
+	unsigned length_code = length_codes()[length];
+	put_literal(257 + length_code);
+	put_bits(length - LENGTH_BASE[length_code], LENGTH_EXTRA[length_code]);
+
+	unsigned code = distance_code(distance);
+	put_bits(reverse_bits(code, 5), 5);
+	put_bits(uint32_t(distance - DISTANCE_BASE[code]), DISTANCE_EXTRA[code]);
+}
+
+void io::Deflater::align() {
+	if (m_bit_count > 0) {
+		put_bits(0, 8 - m_bit_count);
+	}
+}
+
+void io::Deflater::flush_bytes() {
+	if (!m_pending.empty()) {
+		m_output(m_pending.data(), m_pending.size());
+		m_pending.clear();
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef DEFLATE_H
+#define DEFLATE_H
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace io {
+	/// <summary>
+	/// Streaming DEFLATE compressor (RFC 1951) producing a zlib stream (RFC 1950), as used by PNG.
+	/// Input can be fed in pieces of any size; compressed bytes are handed to the output
+	/// callback as they become available, so neither the input nor the output has to be held in full.
+	///
+	/// <paramref name="level" /> trades speed for ratio: 0 stores the input uncompressed,
+	/// 1 to 9 search for LZ77 matches over the last 32 KiB with longer hash chains at higher levels,
+	/// encoding them with the fixed Huffman codes.
+	/// </summary>
+	class Deflater final {
+	public:
+		typedef std::function<void(const uint8_t*, size_t)> Output;
+
+		Deflater(int level, Output output);
+
+		Deflater(const Deflater&) = delete;
+		Deflater& operator=(const Deflater&) = delete;
+
+		void write(const uint8_t* data, size_t size);
+
+		/// <summary>
+		/// Compresses the remaining input and ends the stream. No more writes are allowed afterwards.
+		/// </summary>
+		void finish();
+
+	private:
+		void compress(bool final);
+		void store(bool final);
+		void slide();
+		void insert(size_t position);
+		unsigned longest_match(size_t position, size_t* distance) const;
+
+		void put_bits(uint32_t bits, unsigned count);
+		void put_literal(unsigned symbol);
+		void put_match(unsigned length, size_t distance);
+		void align();
+		void flush_bytes();
+
+		int m_level;
+		unsigned m_max_chain;
+		Output m_output;
+
+		std::vector<uint8_t> m_window;
+		size_t m_position;
+		std::vector<int32_t> m_head;
+		std::vector<int32_t> m_previous;
+
+		uint32_t m_adler;
+		uint64_t m_bit_buffer;
+		unsigned m_bit_count;
+		std::vector<uint8_t> m_pending;
+		bool m_finished;
+	};
+
+	/// <summary>
+	/// Updates a running Adler-32 checksum; start with 1.
+	/// </summary>
+	uint32_t adler32(uint32_t adler, const uint8_t* data, size_t size);
+}
+#endif
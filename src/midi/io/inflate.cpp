@@ -0,0 +1,220 @@
+#include "inflate.h"
+#include "deflate.h"
+#include "logging.h"
+#include <algorithm>
+
+namespace {
+	const unsigned MAX_BITS = 15;
+
+	const uint16_t LENGTH_BASE[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8_t LENGTH_EXTRA[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16_t DISTANCE_BASE[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8_t DISTANCE_EXTRA[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	// Order in which the code length code lengths of a dynamic block are sent
+	const uint8_t CODE_LENGTH_ORDER[] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	// Canonical Huffman code, described by the number of codes of each length and the symbols in code order
+	struct Huffman {
+		uint16_t counts[MAX_BITS + 1];
+		std::vector<uint16_t> symbols;
+
+		Huffman(const uint8_t* lengths, unsigned count) : counts(), symbols() {
+			for (unsigned i = 0; i != count; ++i) {
+				++counts[lengths[i]];
+			}
+			counts[0] = 0;
+
+			for (unsigned length = 1; length <= MAX_BITS; ++length) {
+				for (unsigned i = 0; i != count; ++i) {
+					if (lengths[i] == length) {
+						symbols.push_back(uint16_t(i));
+					}
+				}
+			}
+		}
+	};
+
+	class Inflater {
+	public:
+		Inflater(const uint8_t* data, size_t size) : m_current(data), m_end(data + size), m_bit_buffer(0), m_bit_count(0) { }
+
+		std::vector<uint8_t> run() {
+			bool last;
+
+			do {
+				last = bits(1) == 1;
+
+				switch (bits(2)) {
+				case 0: stored(); break;
+				case 1: fixed(); break;
+				case 2: dynamic(); break;
+				default: CHECK(false) << "Invalid deflate block type";
+				}
+			} while (!last);
+
+			// Whatever is left in the bit buffer beyond the current byte is handed back
+			m_current -= m_bit_count / 8;
+			m_bit_buffer = 0;
+			m_bit_count = 0;
+
+			return std::move(m_out);
+		}
+
+		const uint8_t* position() const { return m_current; }
+
+	private:
+		uint32_t bits(unsigned count) {
+			while (m_bit_count < count) {
+				CHECK(m_current < m_end) << "Truncated deflate stream";
+				m_bit_buffer |= uint32_t(*m_current++) << m_bit_count;
+				m_bit_count += 8;
+			}
+
+			uint32_t result = m_bit_buffer & ((uint32_t(1) << count) - 1);
+			m_bit_buffer >>= count;
+			m_bit_count -= count;
+
+			return result;
+		}
+
+		unsigned decode(const Huffman& code) {
+			int value = 0, first = 0, index = 0;
+
+			for (unsigned length = 1; length <= MAX_BITS; ++length) {
+				value |= int(bits(1));
+				int count = code.counts[length];
+
+				if (value - count < first) {
+					return code.symbols[index + (value - first)];
+				}
+
+				index += count;
+				first = (first + count) << 1;
+				value <<= 1;
+			}
+
+			CHECK(false) << "Invalid Huffman code";
+			return 0;
+		}
+
+		void stored() {
+			m_bit_buffer = 0;
+			m_bit_count = 0;
+
+			CHECK(m_end - m_current >= 4) << "Truncated deflate stream";
+			unsigned length = m_current[0] | (m_current[1] << 8);
+			unsigned complement = m_current[2] | (m_current[3] << 8);
+			m_current += 4;
+
+			CHECK(length == (~complement & 0xFFFF)) << "Corrupt stored block";
+			CHECK(size_t(m_end - m_current) >= length) << "Truncated deflate stream";
+
+			m_out.insert(m_out.end(), m_current, m_current + length);
+			m_current += length;
+		}
+
+		void fixed() {
+			uint8_t lengths[288 + 30];
+			std::fill(lengths, lengths + 144, 8);
+			std::fill(lengths + 144, lengths + 256, 9);
+			std::fill(lengths + 256, lengths + 280, 7);
+			std::fill(lengths + 280, lengths + 288, 8);
+			std::fill(lengths + 288, lengths + 288 + 30, 5);
+
+			codes(Huffman(lengths, 288), Huffman(lengths + 288, 30));
+		}
+
+		void dynamic() {
+			unsigned literal_count = bits(5) + 257;
+			unsigned distance_count = bits(5) + 1;
+			unsigned code_length_count = bits(4) + 4;
+
+			uint8_t code_lengths[19] = { };
+			for (unsigned i = 0; i != code_length_count; ++i) {
+				code_lengths[CODE_LENGTH_ORDER[i]] = uint8_t(bits(3));
+			}
+			Huffman code_length_code(code_lengths, 19);
+
+			std::vector<uint8_t> lengths;
+			while (lengths.size() < literal_count + distance_count) {
+				unsigned symbol = decode(code_length_code);
+
+				if (symbol < 16) {
+					lengths.push_back(uint8_t(symbol));
+				}
+				else {
+					uint8_t value = 0;
+					unsigned repeat;
+
+					if (symbol == 16) {
+						CHECK(!lengths.empty()) << "Repeat without a previous length";
+						value = lengths.back();
+						repeat = 3 + bits(2);
+					}
+					else if (symbol == 17) {
+						repeat = 3 + bits(3);
+					}
+					else {
+						repeat = 11 + bits(7);
+					}
+
+					lengths.insert(lengths.end(), repeat, value);
+				}
+			}
+
+			CHECK(lengths.size() == literal_count + distance_count) << "Code lengths overrun";
+			codes(Huffman(lengths.data(), literal_count), Huffman(lengths.data() + literal_count, distance_count));
+		}
+
+		void codes(const Huffman& literals, const Huffman& distances) {
+			while (true) {
+				unsigned symbol = decode(literals);
+
+				if (symbol < 256) {
+					m_out.push_back(uint8_t(symbol));
+				}
+				else if (symbol == 256) {
+					return;
+				}
+				else {
+					symbol -= 257;
+					CHECK(symbol < 29) << "Invalid length code";
+					unsigned length = LENGTH_BASE[symbol] + bits(LENGTH_EXTRA[symbol]);
+
+					unsigned code = decode(distances);
+					CHECK(code < 30) << "Invalid distance code";
+					size_t distance = DISTANCE_BASE[code] + bits(DISTANCE_EXTRA[code]);
+					CHECK(distance <= m_out.size()) << "Distance too far back";
+
+					size_t from = m_out.size() - distance;
+					for (unsigned i = 0; i != length; ++i) {
+						m_out.push_back(m_out[from + i]);
+					}
+				}
+			}
+		}
+
+		const uint8_t* m_current;
+		const uint8_t* m_end;
+		uint32_t m_bit_buffer;
+		unsigned m_bit_count;
+		std::vector<uint8_t> m_out;
+	};
+}
+
+std::vector<uint8_t> io::inflate(const uint8_t* data, size_t size) {
+	CHECK(size >= 6) << "Truncated zlib stream";
+	CHECK((data[0] & 0x0F) == 8 && (data[0] * 256 + data[1]) % 31 == 0) << "Invalid zlib header";
+	CHECK((data[1] & 0x20) == 0) << "Preset dictionaries are not supported";
+
+	Inflater inflater(data + 2, size - 2);
+	std::vector<uint8_t> result = inflater.run();
+
+	const uint8_t* trailer = inflater.position();
+	CHECK(data + size - trailer == 4) << "Unexpected data after zlib stream";
+	uint32_t checksum = (uint32_t(trailer[0]) << 24) | (uint32_t(trailer[1]) << 16) | (uint32_t(trailer[2]) << 8) | trailer[3];
+	CHECK(checksum == adler32(1, result.data(), result.size())) << "zlib checksum mismatch";
+
+	return result;
+}
@@ -0,0 +1,14 @@
+#ifndef INFLATE_H
+#define INFLATE_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace io {
+	/// <summary>
+	/// Decompresses a complete zlib stream (RFC 1950), as written by <see cref="Deflater" />,
+	/// and verifies its checksum. All three DEFLATE block types are supported.
+	/// </summary>
+	std::vector<uint8_t> inflate(const uint8_t* data, size_t size);
+}
+#endif
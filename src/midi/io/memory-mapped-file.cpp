@@ -0,0 +1,57 @@
+#include "memory-mapped-file.h"
+#include "logging.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+io::MemoryMappedFile::MemoryMappedFile(const std::string& path) : m_data(nullptr), m_size(0), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr) {
+	m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	CHECK(m_file != INVALID_HANDLE_VALUE) << "Could not open " << path;
+
+	LARGE_INTEGER size;
+	CHECK(GetFileSizeEx(m_file, &size)) << "Could not determine size of " << path;
+	m_size = size_t(size.QuadPart);
+
+	if (m_size != 0) {
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CHECK(m_mapping != nullptr) << "Could not map " << path;
+		m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+		CHECK(m_data != nullptr) << "Could not map " << path;
+	}
+}
+
+io::MemoryMappedFile::~MemoryMappedFile() {
+	if (m_data != nullptr) UnmapViewOfFile(m_data);
+	if (m_mapping != nullptr) CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+}
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+io::MemoryMappedFile::MemoryMappedFile(const std::string& path) : m_data(nullptr), m_size(0), m_file(-1) {
+	m_file = open(path.c_str(), O_RDONLY);
+	CHECK(m_file != -1) << "Could not open " << path;
+
+	struct stat info;
+	CHECK(fstat(m_file, &info) == 0) << "Could not determine size of " << path;
+	m_size = size_t(info.st_size);
+
+	if (m_size != 0) {
+		void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+		CHECK(mapping != MAP_FAILED) << "Could not map " << path;
+		madvise(mapping, m_size, MADV_SEQUENTIAL);
+		m_data = static_cast<const uint8_t*>(mapping);
+	}
+}
+
+io::MemoryMappedFile::~MemoryMappedFile() {
+	if (m_data != nullptr) munmap(const_cast<uint8_t*>(m_data), m_size);
+	if (m_file != -1) close(m_file);
+}
+#endif
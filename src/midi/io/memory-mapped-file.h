@@ -0,0 +1,32 @@
+#ifndef MEMORY_MAPPED_FILE_H
+#define MEMORY_MAPPED_FILE_H
+#include <cstdint>
+#include <string>
+
+namespace io {
+	/// <summary>
+	/// Maps a file read-only into memory for the lifetime of the object.
+	/// </summary>
+	class MemoryMappedFile final {
+	public:
+		explicit MemoryMappedFile(const std::string& path);
+		~MemoryMappedFile();
+
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+		MemoryMappedFile& operator =(const MemoryMappedFile&) = delete;
+
+		const uint8_t* data() const { return m_data; }
+		size_t size() const { return m_size; }
+
+	private:
+		const uint8_t* m_data;
+		size_t m_size;
+#ifdef _WIN32
+		void* m_file;
+		void* m_mapping;
+#else
+		int m_file;
+#endif
+	};
+}
+#endif
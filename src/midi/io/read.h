@@ -2,6 +2,8 @@
 #define READ_H
 #include <istream>
 #include <iostream>
+#include <vector>
+#include "byte-span.h"
 #include "logging.h"
 
 namespace io {
@@ -28,5 +30,13 @@ namespace io {
 		read_to(in, result.get(), n);
 		return result;
 	}
+
+	// Reads n bytes into scratch, which is reused from call to call, and returns a span over them.
+	// The span is only valid until scratch is next modified.
+	inline ByteSpan read_span(std::istream& in, size_t n, std::vector<uint8_t>& scratch) {
+		scratch.resize(n);
+		read_to(in, scratch.data(), n);
+		return ByteSpan(scratch.data(), n);
+	}
 }
 #endif
\ No newline at end of file
@@ -1,12 +1,149 @@
 #include "vli.h"
+#include <cstring>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+	// A 64-bit result can absorb another 7 bits only while its top 7 bits are clear.
+	const uint64_t OVERFLOW_MASK = 0xFE00000000000000;
+
+	// Longest encoding any 64-bit value needs; longer runs of 0x80 padding are rejected too.
+	const unsigned MAX_LENGTH = 10;
+
+	uint64_t load_little_endian(const uint8_t* p) {
+		uint64_t word;
+		std::memcpy(&word, p, sizeof(word));
+		return word;
+	}
+
+	uint64_t byte_swap(uint64_t x) {
+#ifdef _MSC_VER
+		return _byteswap_uint64(x);
+#else
+		return __builtin_bswap64(x);
+#endif
+	}
+
+	unsigned count_trailing_zeros(uint64_t x) {
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, x);
+		return index;
+#else
+		return unsigned(__builtin_ctzll(x));
+#endif
+	}
+
+	// Packs the low 7 bits of each byte of x (most significant group in the highest byte)
+	// into one contiguous 56-bit value, i.e. a software PEXT with mask 0x7F7F...7F.
+	uint64_t pack_septets(uint64_t x) {
+		x = ((x & 0x7F007F007F007F00) >> 1) | (x & 0x007F007F007F007F);
+		x = ((x & 0x3FFF00003FFF0000) >> 2) | (x & 0x00003FFF00003FFF);
+		x = ((x & 0x0FFFFFFF00000000) >> 4) | (x & 0x000000000FFFFFFF);
+		return x;
+	}
+
+	io::VliStatus decode_slow(const uint8_t*& current, const uint8_t* end, uint64_t* result) {
+		const uint8_t* p = current;
+		uint64_t res = 0;
+		uint8_t byte;
+		unsigned length = 0;
+		do {
+			if (p == end) return io::VliStatus::truncated;
+			if ((res & OVERFLOW_MASK) || length == MAX_LENGTH) return io::VliStatus::overflow;
+			byte = *p++;
+			++length;
+			res = (res << 7) | (byte & 0b01111111);
+		} while ((byte >> 7) == 0b00000001);
+		*result = res;
+		current = p;
+		return io::VliStatus::ok;
+	}
+}
 
 uint64_t io::read_variable_length_integer(std::istream& in) {
 	uint8_t byte = in.get();
 	uint64_t res = 0x0000000000000000;
+	unsigned length = 1;
 	while ((byte >> 7) == 0b00000001) {
+		CHECK(in.good()) << "Truncated variable length integer";
+		CHECK((res & OVERFLOW_MASK) == 0 && length < MAX_LENGTH) << "Variable length integer does not fit in 64 bits";
 		res = (res << 7) | (byte & 0b01111111);
 		byte = in.get();
+		++length;
 	}
+	CHECK((res & OVERFLOW_MASK) == 0) << "Variable length integer does not fit in 64 bits";
 	res = (res << 7) | (byte & 0b01111111);
 	return res;
+}
+
+uint64_t io::read_variable_length_integer(ByteCursor& in) {
+	uint64_t result;
+	VliStatus status = decode_variable_length_integer(in.current, in.end, &result);
+	CHECK(status != VliStatus::truncated) << "Read past end of buffer";
+	CHECK(status != VliStatus::overflow) << "Variable length integer does not fit in 64 bits";
+	return result;
+}
+
+io::VliStatus io::decode_variable_length_integer(const uint8_t*& current, const uint8_t* end, uint64_t* result) {
+	size_t available = size_t(end - current);
+
+	// Delta times are overwhelmingly one or two bytes long.
+	if (available >= 2) {
+		uint8_t first = current[0];
+		if (first < 0x80) {
+			*result = first;
+			current += 1;
+			return VliStatus::ok;
+		}
+		uint8_t second = current[1];
+		if (second < 0x80) {
+			*result = (uint64_t(first & 0x7F) << 7) | second;
+			current += 2;
+			return VliStatus::ok;
+		}
+	}
+
+	// Longer encodings: locate the terminating byte of up to 8 bytes at once
+	// and gather the septets without a data-dependent loop.
+	if (available >= 8) {
+		uint64_t word = load_little_endian(current);
+		uint64_t terminators = ~word & 0x8080808080808080;
+		if (terminators != 0) {
+			unsigned length = count_trailing_zeros(terminators) / 8 + 1;
+			uint64_t septets = byte_swap(word & 0x7F7F7F7F7F7F7F7F) >> (8 * (8 - length));
+			*result = pack_septets(septets);
+			current += length;
+			return VliStatus::ok;
+		}
+	}
+
+	return decode_slow(current, end, result);
+}
+
+size_t io::decode_variable_length_integers(const uint8_t*& current, const uint8_t* end, uint64_t* results, size_t count, VliStatus* status) {
+	size_t decoded = 0;
+	VliStatus last = VliStatus::ok;
+
+	// Bulk of the run: plenty of slack, so single-byte values skip all bounds checks.
+	while (decoded != count && size_t(end - current) >= 8) {
+		uint8_t first = *current;
+		if (first < 0x80) {
+			results[decoded++] = first;
+			++current;
+			continue;
+		}
+		last = decode_variable_length_integer(current, end, &results[decoded]);
+		if (last != VliStatus::ok) break;
+		++decoded;
+	}
+
+	while (last == VliStatus::ok && decoded != count) {
+		last = decode_variable_length_integer(current, end, &results[decoded]);
+		if (last == VliStatus::ok) ++decoded;
+	}
+
+	if (status != nullptr) *status = last;
+	return decoded;
 }
\ No newline at end of file
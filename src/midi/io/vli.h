@@ -2,8 +2,25 @@
 #define VLI_H
 #include <istream>
 #include "read.h"
+#include "byte-cursor.h"
 
 namespace io {
+	enum class VliStatus { ok, truncated, overflow };
+
 	uint64_t read_variable_length_integer(std::istream& in);
+	uint64_t read_variable_length_integer(ByteCursor& in);
+
+	/// <summary>
+	/// Decodes a single variable length integer from [current, end) into <paramref name="result" />.
+	/// On success <paramref name="current" /> is advanced past it; on failure it is left untouched.
+	/// Never reads at or beyond <paramref name="end" />.
+	/// </summary>
+	VliStatus decode_variable_length_integer(const uint8_t*& current, const uint8_t* end, uint64_t* result);
+
+	/// <summary>
+	/// Decodes up to <paramref name="count" /> consecutive variable length integers in one pass.
+	/// Returns how many were decoded; <paramref name="status" /> tells why decoding stopped early.
+	/// </summary>
+	size_t decode_variable_length_integers(const uint8_t*& current, const uint8_t* end, uint64_t* results, size_t count, VliStatus* status);
 }
 #endif
\ No newline at end of file
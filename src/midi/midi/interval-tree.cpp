@@ -0,0 +1,99 @@
+#include "interval-tree.h"
+#include <algorithm>
+
+namespace midi {
+	namespace {
+		Time end_of(const NoteTable& table, size_t row) {
+			return table.start(row) + table.duration(row);
+		}
+
+		// Fills max_ends for the subtree over rows[low, high) rooted at its midpoint, returns its latest end
+		Time build(const NoteTable& table, const std::vector<size_t>& rows, std::vector<Time>& max_ends, size_t low, size_t high) {
+			if (low >= high){
+				return Time(0);
+			}
+			size_t mid = low + (high - low) / 2;
+			Time result = std::max(end_of(table, rows[mid]), std::max(build(table, rows, max_ends, low, mid), build(table, rows, max_ends, mid + 1, high)));
+			max_ends[mid] = result;
+			return result;
+		}
+
+		std::vector<size_t> all_rows(const NoteTable& table) {
+			std::vector<size_t> rows(table.size());
+			for (size_t i = 0; i < rows.size(); i++){
+				rows[i] = i;
+			}
+			return rows;
+		}
+	}
+
+	IntervalTree::IntervalTree(std::vector<NOTE> notes) : m_owned(notes), m_table(nullptr) {
+		index(all_rows(m_owned));
+	}
+
+	IntervalTree::IntervalTree(const NoteTable& table) : m_table(&table) {
+		index(all_rows(table));
+	}
+
+	IntervalTree::IntervalTree(const NoteTable& table, std::vector<size_t> rows) : m_table(&table) {
+		index(std::move(rows));
+	}
+
+	void IntervalTree::index(std::vector<size_t> rows) {
+		const NoteTable& notes = table();
+		m_rows = std::move(rows);
+		std::stable_sort(m_rows.begin(), m_rows.end(), [&notes](size_t a, size_t b)
+		{ return notes.start(a) < notes.start(b); });
+		m_max_ends.resize(m_rows.size());
+		build(notes, m_rows, m_max_ends, 0, m_rows.size());
+	}
+
+	std::vector<NOTE> IntervalTree::notes() const {
+		std::vector<NOTE> result;
+		result.reserve(m_rows.size());
+		for (size_t row : m_rows){
+			result.push_back(table()[row]);
+		}
+		return result;
+	}
+
+	void IntervalTree::visit(size_t low, size_t high, Time from, Time to, const std::function<void(size_t)>& receiver) const {
+		if (low >= high){
+			return;
+		}
+		size_t mid = low + (high - low) / 2;
+		if (m_max_ends[mid] <= from){
+			return;
+		}
+		visit(low, mid, from, to, receiver);
+		const NoteTable& notes = table();
+		size_t row = m_rows[mid];
+		// Everything from mid onwards starts too late
+		if (notes.start(row) >= to){
+			return;
+		}
+		if (end_of(notes, row) > from){
+			receiver(row);
+		}
+		visit(mid + 1, high, from, to, receiver);
+	}
+
+	void IntervalTree::for_each_overlapping(Time from, Time to, std::function<void(const NOTE&)> receiver) const {
+		const NoteTable& notes = table();
+		for_each_overlapping_row(from, to, [&notes, &receiver](size_t row)
+		{ receiver(notes[row]); });
+	}
+
+	void IntervalTree::for_each_overlapping_row(Time from, Time to, std::function<void(size_t)> receiver) const {
+		if (from < to){
+			visit(0, m_rows.size(), from, to, receiver);
+		}
+	}
+
+	std::vector<NOTE> IntervalTree::overlapping(Time from, Time to) const {
+		std::vector<NOTE> result;
+		for_each_overlapping(from, to, [&result](const NOTE& note)
+		{ result.push_back(note); });
+		return result;
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef INTERVAL_TREE_H
+#define INTERVAL_TREE_H
+
+#include "midi.h"
+#include "note-table.h"
+#include <functional>
+#include <vector>
+
+namespace midi {
+	// Static interval tree over the [start, start + duration) spans of a set of notes.
+	// Row indices into a NoteTable are kept sorted by start; the tree is implicit in that order,
+	// every node storing the latest end of its subtree so whole subtrees can be skipped.
+	// Queries cost O(log n + k) for k results.
+	class IntervalTree {
+	public:
+		IntervalTree() : m_table(nullptr) {};
+		explicit IntervalTree(std::vector<NOTE> notes);
+		// Indexes the table in place, without copying the notes; the table must outlive the tree
+		explicit IntervalTree(const NoteTable& table);
+		explicit IntervalTree(NoteTable&& table) = delete;
+		// Same, but only indexes the given rows of the table
+		IntervalTree(const NoteTable& table, std::vector<size_t> rows);
+		IntervalTree(NoteTable&& table, std::vector<size_t> rows) = delete;
+
+		size_t size() const { return m_rows.size(); }
+		bool empty() const { return m_rows.empty(); }
+
+		// All notes, ordered by start; built on every call
+		std::vector<NOTE> notes() const;
+		// Row indices of all notes in the table, ordered by start
+		const std::vector<size_t>& rows() const { return m_rows; }
+
+		// Calls receiver for every note sounding somewhere in [from, to), ordered by start
+		void for_each_overlapping(Time from, Time to, std::function<void(const NOTE&)> receiver) const;
+		std::vector<NOTE> overlapping(Time from, Time to) const;
+		// Same as for_each_overlapping, passing row indices into the table
+		void for_each_overlapping_row(Time from, Time to, std::function<void(size_t)> receiver) const;
+
+	private:
+		const NoteTable& table() const { return m_table != nullptr ? *m_table : m_owned; }
+		void index(std::vector<size_t> rows);
+		void visit(size_t low, size_t high, Time from, Time to, const std::function<void(size_t)>& receiver) const;
+
+		// Only used when the tree is built from a vector of notes; m_table is null then,
+		// which keeps copies of the tree valid
+		NoteTable m_owned;
+		const NoteTable* m_table;
+		std::vector<size_t> m_rows;
+		// m_max_ends[i]: latest end among the notes in the subtree rooted at i
+		std::vector<Time> m_max_ends;
+	};
+}
+#endif
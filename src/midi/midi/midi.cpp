@@ -1,12 +1,34 @@
 #include "midi.h"
+#include "mtrk-reader.h"
 #include "../io/read.h"
 #include "../io/endianness.h"
 #include "../io/vli.h"
+#include "util/parallel.h"
 
 namespace midi {
+	namespace {
+		template<typename INPUT>
+		void read_chunk_header_from(INPUT& in, CHUNK_HEADER* head) {
+			io::read_to(in, head);
+			io::switch_endianness(&head->size);
+		}
+
+		template<typename INPUT>
+		void read_mthd_from(INPUT& in, MTHD* mthhead) {
+			io::read_to(in, mthhead);
+			io::switch_endianness(&mthhead->header.size);
+			io::switch_endianness(&mthhead->type);
+			io::switch_endianness(&mthhead->division);
+			io::switch_endianness(&mthhead->ntracks);
+		}
+	}
+
 	void read_chunk_header(std::istream& in, CHUNK_HEADER* head) {
-		io::read_to(in, head);
-		io::switch_endianness(&head->size);
+		read_chunk_header_from(in, head);
+	}
+
+	void read_chunk_header(io::ByteCursor& in, CHUNK_HEADER* head) {
+		read_chunk_header_from(in, head);
 	}
 
 	std::string header_id(CHUNK_HEADER head) {
@@ -14,11 +36,11 @@ namespace midi {
 	}
 
 	void read_mthd(std::istream& in, MTHD* mthhead) {
-		io::read_to(in, mthhead);
-		io::switch_endianness(&mthhead->header.size);
-		io::switch_endianness(&mthhead->type);
-		io::switch_endianness(&mthhead->division);
-		io::switch_endianness(&mthhead->ntracks);
+		read_mthd_from(in, mthhead);
+	}
+
+	void read_mthd(io::ByteCursor& in, MTHD* mthhead) {
+		read_mthd_from(in, mthhead);
 	}
 	
 	bool is_meta_event(uint8_t byte) {
@@ -66,78 +88,23 @@ namespace midi {
 	}
 
 	void read_mtrk(std::istream& in, EventReceiver& receiver) {
-		CHUNK_HEADER header;
-		read_chunk_header(in, &header);
-		uint8_t previous_identifier;
-
-		bool end_track_reached = false;
-		while (!end_track_reached){
-			Duration duration(io::read_variable_length_integer(in));
-			uint8_t identifier = io::read<uint8_t>(in);
-			uint8_t first_data;
-
-			if ((identifier & 0b1000'0000) == 0b0000'0000){
-				first_data = identifier;
-				identifier = previous_identifier;
-			}
-			else{
-				first_data = io::read<uint8_t>(in);
-			}
-			if (is_meta_event(identifier)){
-				auto length = io::read_variable_length_integer(in);
-				auto type = first_data;
-				std::unique_ptr<uint8_t[]> data = io::read_array<uint8_t>(in, length);
-				receiver.meta(duration, type, std::move(data), length);
-				if (type == 0x2F) end_track_reached = true;
-			}
-			else if (is_sysex_event(identifier)){
-				in.putback(first_data);
-				auto length = io::read_variable_length_integer(in);
-				std::unique_ptr<uint8_t[]> data = io::read_array<uint8_t>(in, length);
-				receiver.sysex(duration, std::move(data), length);
-			}
+		read_mtrk<std::istream, EventReceiver>(in, receiver);
+	}
 
-			else if (is_midi_event(identifier)){
-				auto event_type = extract_midi_event_type(identifier);
-				Channel channel(extract_midi_event_channel(identifier));
-
-				if (is_note_off(event_type)){
-					NoteNumber note = NoteNumber(first_data);
-					auto velocity = io::read<uint8_t>(in);
-					receiver.note_off(duration, channel, note, velocity);
-				}
-				else if(is_note_on(event_type)){
-					NoteNumber note = NoteNumber(first_data);
-					auto velocity = io::read<uint8_t>(in);
-					receiver.note_on(duration, channel, note, velocity);
-				}
-				else if (is_polyphonic_key_pressure(event_type)){
-					NoteNumber note(first_data);
-					auto pressure = io::read<uint8_t>(in);
-					receiver.polyphonic_key_pressure(duration, channel, note, pressure);
-				}
-				else if (is_control_change(event_type)){
-					auto controller = first_data;
-					auto value = io::read<uint8_t>(in);
-					receiver.control_change(duration, channel, controller, value);
-				}
-				else if (is_program_change(event_type)){
-					Instrument program(first_data);
-					receiver.program_change(duration, channel, program);
-				}
-				else if (is_channel_pressure(event_type)){
-					auto pressure = first_data;
-					receiver.channel_pressure(duration, channel, pressure);
-				}
-				else if (is_pitch_wheel_change(event_type)){
-					auto lower_bits = first_data;
-					auto upper_bits = io::read<uint8_t>(in);
-					auto value = upper_bits << 7 | lower_bits;
-					receiver.pitch_wheel_change(duration, channel, value);
-				}
-			}
-			previous_identifier = identifier;
-		}
+	void read_mtrk(io::ByteCursor& in, EventReceiver& receiver) {
+		read_mtrk<io::ByteCursor, EventReceiver>(in, receiver);
+	}
+
+
+	// EventReceiver
+
+
+	void EventReceiver::meta(Duration dt, uint8_t type, io::ByteSpan data){
+		meta(dt, type, data.copy(), data.size);
+	}
+
+	void EventReceiver::sysex(Duration dt, io::ByteSpan data){
+		sysex(dt, data.copy(), data.size);
 	}
 
 
@@ -145,32 +112,18 @@ namespace midi {
 
 
 	void ChannelNoteCollector::note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity){
-		if (channel == this->channel){
-			if (velocity == 0b00000000){
-				note_off(dt, channel, note, velocity);
-			}
-			else {
-				this->start += dt;
-				NOTE noot = NOTE();
-				noot.note_number = note;
-				noot.start = this->start;
-				noot.velocity = velocity;
-				noot.instrument = this->instrument;
-				bool exists = false;
-				for (int i = 0; i < this->notes.size(); i++){
-					if (this->notes[i].note_number == note){
-						note_off(dt, channel, note, velocity);
-						exists = true;
-						break;
-					}
-				}
-				if (!exists){
-					for (int i = 0; i < this->notes.size(); i++){
-						this->notes[i].duration += dt;
-					}
-				}
-				this->notes.push_back(noot);
-			}
+		if (channel == this->channel && velocity == 0){
+			note_off(dt, channel, note, velocity);
+		}
+		else if (channel == this->channel && value(note) < this->pending.size()){
+			this->now += dt;
+			// A note on for a note that is still sounding ends it first
+			release(note);
+			PendingNote& slot = this->pending[value(note)];
+			slot.start = this->now;
+			slot.velocity = velocity;
+			slot.instrument = this->instrument;
+			slot.active = true;
 		}
 		else {
 			action_other_channel(dt);
@@ -178,107 +131,61 @@ namespace midi {
 	}
 
 	void ChannelNoteCollector::note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity){
-		if (channel == this->channel){
-			int index = -1;
-			for (int i = 0; i < this->notes.size(); i++){
-				this->notes[i].duration += dt;
-				if (this->notes[i].note_number == note) {
-					NOTE noot = this->notes[i];
-					this->note_receiver(noot);
-					index = i;
-				}
-			}
-			if (index != -1){
-				this->notes.erase(this->notes.begin() + index);
-			}
-			this->start += dt;
+		this->now += dt;
+		if (channel == this->channel && value(note) < this->pending.size()){
+			release(note);
 		}
-		else {
-			action_other_channel(dt);
+	}
+
+	void ChannelNoteCollector::release(NoteNumber note){
+		PendingNote& slot = this->pending[value(note)];
+		if (slot.active){
+			this->note_receiver(NOTE(note, slot.start, this->now - slot.start, slot.velocity, slot.instrument));
+			slot.active = false;
 		}
 	}
 
 	void ChannelNoteCollector::polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure){
-		if (channel == this->channel){
-			for (int i = 0; i < this->notes.size(); i++){
-				this->notes[i].duration += dt;
-			}
-			this->start += dt;
-		}
-		else {
-			action_other_channel(dt);
-		}
+		action_other_channel(dt);
 	}
 
 	void ChannelNoteCollector::control_change(Duration dt, Channel channel, uint8_t controller, uint8_t value){
-		if (channel == this->channel){
-			for (int i = 0; i < this->notes.size(); i++)
-			{
-				this->notes[i].duration += dt;
-			}
-			this->start += dt;
-		}
-		else {
-			action_other_channel(dt);
-		}
+		action_other_channel(dt);
 	}
 
 	void ChannelNoteCollector::program_change(Duration dt, Channel channel, Instrument program){
 		if (channel == this->channel){
 			this->instrument = program;
-			for (int i = 0; i < this->notes.size(); i++){
-				this->notes[i].duration += dt;
-			}
-			this->start += dt;
-		}
-		else {
-			action_other_channel(dt);
 		}
+		action_other_channel(dt);
 	}
 
 	void ChannelNoteCollector::channel_pressure(Duration dt, Channel channel, uint8_t pressure){
-		if (channel == this->channel){
-			for (int i = 0; i < this->notes.size(); i++){
-				this->notes[i].duration += dt;
-			}
-			this->start += dt;
-		}
-		else {
-			action_other_channel(dt);
-		}
+		action_other_channel(dt);
 	}
 
 	void ChannelNoteCollector::pitch_wheel_change(Duration dt, Channel channel, uint16_t value){
-		if (channel == this->channel){
-			for (int i = 0; i < this->notes.size(); i++){
-				this->notes[i].duration += dt;
-			}
-			this->start += dt;
-		}
-		else {
-			action_other_channel(dt);
-		}
+		action_other_channel(dt);
 	}
 
 	void ChannelNoteCollector::meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size){
-		for (int i = 0; i < this->notes.size(); i++){
-			this->notes[i].duration += dt;
-		}
-		this->start += dt;
+		action_other_channel(dt);
 	}
 
 	void ChannelNoteCollector::sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size){
-		for (int i = 0; i < this->notes.size(); i++){
-			this->notes[i].duration += dt;
-		}
-		this->start += dt;
+		action_other_channel(dt);
+	}
+
+	void ChannelNoteCollector::meta(Duration dt, uint8_t type, io::ByteSpan data){
+		action_other_channel(dt);
+	}
+
+	void ChannelNoteCollector::sysex(Duration dt, io::ByteSpan data){
+		action_other_channel(dt);
 	}
 
 	void ChannelNoteCollector::action_other_channel(Duration dt){
-		for (int i = 0; i < this->notes.size(); i++){
-			this->notes[i].duration += dt;
-		}
-		this->start += dt;
+		this->now += dt;
 	}
 
 	std::ostream&operator<<(std::ostream& out, const NOTE& note) {
@@ -336,14 +243,21 @@ namespace midi {
 			event_receiver->pitch_wheel_change(dt, channel, value);
 		}
 	}
+	// Every receiver gets to see the payload, so it is handed out as a span rather than moved into the first one
 	void EventMulticaster::meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size){
+		meta(dt, type, io::ByteSpan(data.get(), data_size));
+	}
+	void EventMulticaster::sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size){
+		sysex(dt, io::ByteSpan(data.get(), data_size));
+	}
+	void EventMulticaster::meta(Duration dt, uint8_t type, io::ByteSpan data){
 		for (const auto& event_receiver : receivers){
-			event_receiver->meta(dt, type, std::move(data), data_size);
+			event_receiver->meta(dt, type, data);
 		}
 	}
-	void EventMulticaster::sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size){
+	void EventMulticaster::sysex(Duration dt, io::ByteSpan data){
 		for (const auto& event_receiver : receivers){
-			event_receiver->sysex(dt, std::move(data), data_size);
+			event_receiver->sysex(dt, data);
 		}
 	}
 	void EventMulticaster::add_event_receiver(const std::shared_ptr<EventReceiver>& eventReceiver){
@@ -356,43 +270,136 @@ namespace midi {
 	// NoteCollector 
 
 
-	void NoteCollector::note_on(Duration dt,Channel channel, NoteNumber note, uint8_t velocity){
-		this->multicaster.note_on(dt, channel, note, velocity);
+	PendingNote* NoteCollector::slot(Channel channel, NoteNumber note){
+		if (value(channel) < this->instruments.size() && value(note) < 128){
+			return &this->pending[value(channel) * 128 + value(note)];
+		}
+		return nullptr;
+	}
+
+	void NoteCollector::release(PendingNote* slot, NoteNumber note){
+		if (slot->active){
+			this->receiver(NOTE(note, slot->start, this->now - slot->start, slot->velocity, slot->instrument));
+			slot->active = false;
+		}
+	}
+
+	void NoteCollector::note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity){
+		this->now += dt;
+		PendingNote* pending = slot(channel, note);
+		if (pending != nullptr){
+			release(pending, note);
+			if (velocity != 0){
+				pending->start = this->now;
+				pending->velocity = velocity;
+				pending->instrument = this->instruments[value(channel)];
+				pending->active = true;
+			}
+		}
 	}
 	void NoteCollector::note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity){
-		this->multicaster.note_off(dt, channel, note, velocity);
+		this->now += dt;
+		PendingNote* pending = slot(channel, note);
+		if (pending != nullptr){
+			release(pending, note);
+		}
 	}
 	void NoteCollector::polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure){
-		this->multicaster.polyphonic_key_pressure(dt, channel, note, pressure);
+		this->now += dt;
 	}
 	void NoteCollector::control_change(Duration dt, Channel channel, uint8_t controller, uint8_t value){
-		this->multicaster.control_change(dt, channel, controller, value);
+		this->now += dt;
 	}
 	void NoteCollector::program_change(Duration dt, Channel channel, Instrument program){
-		this->multicaster.program_change(dt, channel, program);
+		this->now += dt;
+		if (value(channel) < this->instruments.size()){
+			this->instruments[value(channel)] = program;
+		}
 	}
 	void NoteCollector::channel_pressure(Duration dt, Channel channel, uint8_t pressure){
-		this->multicaster.channel_pressure(dt, channel, pressure);
+		this->now += dt;
 	}
 	void NoteCollector::pitch_wheel_change(Duration dt, Channel channel, uint16_t value){
-		this->multicaster.pitch_wheel_change(dt, channel, value);
+		this->now += dt;
 	}
 	void NoteCollector::meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size){
-		this->multicaster.meta(dt, type, std::move(data), data_size);
+		this->now += dt;
 	}
 	void NoteCollector::sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size){
-		this->multicaster.sysex(dt, std::move(data), data_size);
+		this->now += dt;
+	}
+	void NoteCollector::meta(Duration dt, uint8_t type, io::ByteSpan data){
+		this->now += dt;
+	}
+	void NoteCollector::sysex(Duration dt, io::ByteSpan data){
+		this->now += dt;
+	}
+
+	namespace {
+		template<typename INPUT>
+		std::vector<NOTE> read_notes_from(INPUT& in){
+			MTHD mthhead;
+			read_mthd(in, &mthhead);
+			std::vector<NOTE> notes;
+
+			for (int i = 0; i < mthhead.ntracks; i++){
+				NoteCollector collector = NoteCollector([&notes](const NOTE& note)
+				{ notes.push_back(note); });
+				read_mtrk(in, collector);
+			}
+			return notes;
+		}
 	}
 
 	std::vector<NOTE> read_notes(std::istream& in){
+		return read_notes_from(in);
+	}
+
+	std::vector<NOTE> read_notes(const uint8_t* data, size_t size){
+		io::ByteCursor in(data, size);
+		return read_notes_from(in);
+	}
+
+	std::vector<io::ByteCursor> find_mtrk_chunks(const uint8_t* data, size_t size, MTHD* mthd){
+		io::ByteCursor in(data, size);
+		read_mthd(in, mthd);
+		in.skip(mthd->header.size - (sizeof(MTHD) - sizeof(CHUNK_HEADER)));
+
+		std::vector<io::ByteCursor> tracks;
+		while (tracks.size() < mthd->ntracks && !in.at_end()){
+			io::ByteCursor chunk = in;
+			CHUNK_HEADER header;
+			read_chunk_header(in, &header);
+			in.skip(header.size);
+
+			if (header_id(header) == "MTrk"){
+				tracks.push_back(chunk);
+			}
+		}
+		return tracks;
+	}
+
+	std::vector<NOTE> read_notes_parallel(const uint8_t* data, size_t size, unsigned workers){
 		MTHD mthhead;
-		read_mthd(in, &mthhead);
-		std::vector<NOTE> notes;
+		std::vector<io::ByteCursor> tracks = find_mtrk_chunks(data, size, &mthhead);
+		std::vector<std::vector<NOTE>> track_notes(tracks.size());
 
-		for (int i = 0; i < mthhead.ntracks; i++){
+		parallel_for(tracks.size(), workers, [&tracks, &track_notes](size_t i){
+			std::vector<NOTE>& notes = track_notes[i];
 			NoteCollector collector = NoteCollector([&notes](const NOTE& note)
 			{ notes.push_back(note); });
-			read_mtrk(in, collector);
+			read_mtrk(tracks[i], collector);
+		});
+
+		size_t total = 0;
+		for (const auto& notes : track_notes){
+			total += notes.size();
+		}
+
+		std::vector<NOTE> notes;
+		notes.reserve(total);
+		for (const auto& part : track_notes){
+			notes.insert(notes.end(), part.begin(), part.end());
 		}
 		return notes;
 	}
@@ -5,6 +5,9 @@
 #include <sstream>
 #include <istream>
 #include "primitives.h"
+#include "io/byte-cursor.h"
+#include "io/byte-span.h"
+#include <array>
 #include <functional>
 #include <vector>
 #include <memory>
@@ -16,6 +19,7 @@ namespace midi {
 		uint32_t size;
 	};
 	void read_chunk_header(std::istream&, CHUNK_HEADER*);
+	void read_chunk_header(io::ByteCursor&, CHUNK_HEADER*);
 
 	std::string header_id(CHUNK_HEADER);
 
@@ -28,6 +32,7 @@ namespace midi {
 	};
 #pragma pack(pop)
 	void read_mthd(std::istream&, MTHD*);
+	void read_mthd(io::ByteCursor&, MTHD*);
 	bool is_sysex_event(uint8_t);
 	bool is_meta_event(uint8_t);
 	bool is_midi_event(uint8_t);
@@ -53,9 +58,17 @@ namespace midi {
 		virtual void pitch_wheel_change(Duration dt, Channel channel, uint16_t value) = 0;
 		virtual void meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) = 0;
 		virtual void sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) = 0;
+
+		// What read_mtrk calls: data points into the input and is only valid during the call.
+		// By default the payload is copied and passed on to the owning overloads above;
+		// receivers that ignore or only inspect it override these to avoid the allocation.
+		virtual void meta(Duration dt, uint8_t type, io::ByteSpan data);
+		virtual void sysex(Duration dt, io::ByteSpan data);
 	};
 
+	// Virtual dispatch to any receiver; mtrk-reader.h has the statically dispatched template
 	void read_mtrk(std::istream&, EventReceiver&);
+	void read_mtrk(io::ByteCursor&, EventReceiver&);
 
 	//ChannelNoteCollector
 
@@ -74,15 +87,29 @@ namespace midi {
 	bool operator ==(const NOTE& x, const NOTE& y);
 	bool operator !=(const NOTE& x, const NOTE& y);
 
+	// A note that has started but not yet ended
+	struct PendingNote{
+		Time start;
+		uint8_t velocity;
+		Instrument instrument;
+		bool active;
+
+		PendingNote() : start(0), velocity(0), instrument(0), active(false) {};
+	};
+
+	// Keeps the absolute time and one slot per note number, so every event costs O(1)
+	// regardless of how many notes are sounding
 	class ChannelNoteCollector : public EventReceiver{
 		Channel channel;
 		std::function<void(const NOTE&)> note_receiver;
-		std::vector<NOTE> notes;
-		Time start;
+		std::array<PendingNote, 128> pending;
+		Time now;
 		Instrument instrument;
 
+		void release(NoteNumber note);
+
 	public:
-		ChannelNoteCollector(Channel channel, std::function<void(const NOTE&)> note_receiver) : channel(channel), note_receiver(note_receiver), start(0), notes(0), instrument(0) {};
+		ChannelNoteCollector(Channel channel, std::function<void(const NOTE&)> note_receiver) : channel(channel), note_receiver(note_receiver), now(0), instrument(0) {};
 		void note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override;
 		void note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override;
 		void polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure) override;
@@ -92,6 +119,8 @@ namespace midi {
 		void pitch_wheel_change(Duration dt, Channel channel, uint16_t value) override;
 		void meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
 		void sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
+		void meta(Duration dt, uint8_t type, io::ByteSpan data) override;
+		void sysex(Duration dt, io::ByteSpan data) override;
 		void action_other_channel(Duration dt);
 	};
 
@@ -113,6 +142,8 @@ namespace midi {
 		void pitch_wheel_change(Duration dt, Channel channel, uint16_t value) override;
 		void meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
 		void sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
+		void meta(Duration dt, uint8_t type, io::ByteSpan data) override;
+		void sysex(Duration dt, io::ByteSpan data) override;
 		void add_event_receiver(const std::shared_ptr<EventReceiver>&);
 	};
 
@@ -120,21 +151,19 @@ namespace midi {
 	//NoteCollector
 
 
-	class NoteCollector : public EventReceiver{
-	public:
+	// Collects the notes of all 16 channels in a single pass: the state of every channel lives in
+	// one flat table and each event only touches the channel it belongs to
+	class NoteCollector final : public EventReceiver{
 		std::function<void(const NOTE&)> receiver;
-		EventMulticaster multicaster;
+		std::array<PendingNote, 16 * 128> pending;
+		std::array<Instrument, 16> instruments;
+		Time now;
 
-		static std::vector<std::shared_ptr<EventReceiver >> create_list(std::function<void(const NOTE&)> receiver){
-			std::vector<std::shared_ptr<EventReceiver>> receivers;
-			for (int channel = 0; channel < 16; channel++){
-				auto shptr = std::make_shared<ChannelNoteCollector>(Channel(channel), receiver);
-				receivers.push_back(shptr);
-			}
-			return receivers;
-		}
+		PendingNote* slot(Channel channel, NoteNumber note);
+		void release(PendingNote* slot, NoteNumber note);
 
-		NoteCollector(std::function<void(const NOTE&)> receiver) : receiver(receiver), multicaster(create_list(receiver)) { }
+	public:
+		NoteCollector(std::function<void(const NOTE&)> receiver) : receiver(receiver), now(0) {};
 
 		void note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override;
 		void note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override;
@@ -145,7 +174,16 @@ namespace midi {
 		void pitch_wheel_change(Duration dt, Channel channel, uint16_t value) override;
 		void meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
 		void sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
+		void meta(Duration dt, uint8_t type, io::ByteSpan data) override;
+		void sysex(Duration dt, io::ByteSpan data) override;
 	};
 	std::vector<NOTE> read_notes(std::istream&);
+	std::vector<NOTE> read_notes(const uint8_t* data, size_t size);
+
+	// Cursors positioned at each MTrk chunk, in file order; unknown chunks are skipped
+	std::vector<io::ByteCursor> find_mtrk_chunks(const uint8_t* data, size_t size, MTHD* mthd);
+
+	// Same result as read_notes, tracks parsed concurrently (workers == 0: one per core)
+	std::vector<NOTE> read_notes_parallel(const uint8_t* data, size_t size, unsigned workers = 0);
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+#ifndef MTRK_READER_H
+#define MTRK_READER_H
+
+#include "midi.h"
+#include "io/read.h"
+#include "io/byte-cursor.h"
+#include "io/vli.h"
+#include <vector>
+
+namespace midi {
+	namespace detail {
+		// Receivers with a span overload get the payload in place; others, such as ones that
+		// only override the owning overload and thereby hide the span one, get a copy
+		template<typename RECEIVER>
+		auto deliver_meta(RECEIVER& receiver, Duration dt, uint8_t type, io::ByteSpan data, int) -> decltype(receiver.meta(dt, type, data), void()) {
+			receiver.meta(dt, type, data);
+		}
+
+		template<typename RECEIVER>
+		void deliver_meta(RECEIVER& receiver, Duration dt, uint8_t type, io::ByteSpan data, long) {
+			receiver.meta(dt, type, data.copy(), data.size);
+		}
+
+		template<typename RECEIVER>
+		auto deliver_sysex(RECEIVER& receiver, Duration dt, io::ByteSpan data, int) -> decltype(receiver.sysex(dt, data), void()) {
+			receiver.sysex(dt, data);
+		}
+
+		template<typename RECEIVER>
+		void deliver_sysex(RECEIVER& receiver, Duration dt, io::ByteSpan data, long) {
+			receiver.sysex(dt, data.copy(), data.size);
+		}
+	}
+
+	// Parses one MTrk chunk, calling RECEIVER's member functions directly. With a concrete (preferably final)
+	// receiver whose definitions are visible the calls can be inlined into the loop; the non-template
+	// read_mtrk overloads in midi.h instantiate it with EventReceiver and dispatch virtually.
+	// INPUT only needs the io::read* overloads and putback, so both std::istream and io::ByteCursor work.
+	template<typename INPUT, typename RECEIVER>
+	void read_mtrk(INPUT& in, RECEIVER& receiver) {
+		CHUNK_HEADER header;
+		read_chunk_header(in, &header);
+		uint8_t previous_identifier;
+		// Only used for std::istream input; a ByteCursor hands out spans into its own buffer
+		std::vector<uint8_t> scratch;
+
+		bool end_track_reached = false;
+		while (!end_track_reached){
+			Duration duration(io::read_variable_length_integer(in));
+			uint8_t identifier = io::read<uint8_t>(in);
+			uint8_t first_data;
+
+			if ((identifier & 0b1000'0000) == 0b0000'0000){
+				first_data = identifier;
+				identifier = previous_identifier;
+			}
+			else{
+				first_data = io::read<uint8_t>(in);
+			}
+			if (is_meta_event(identifier)){
+				auto length = io::read_variable_length_integer(in);
+				auto type = first_data;
+				io::ByteSpan data = io::read_span(in, length, scratch);
+				detail::deliver_meta(receiver, duration, type, data, 0);
+				if (type == 0x2F) end_track_reached = true;
+			}
+			else if (is_sysex_event(identifier)){
+				in.putback(first_data);
+				auto length = io::read_variable_length_integer(in);
+				io::ByteSpan data = io::read_span(in, length, scratch);
+				detail::deliver_sysex(receiver, duration, data, 0);
+			}
+
+			else if (is_midi_event(identifier)){
+				auto event_type = extract_midi_event_type(identifier);
+				Channel channel(extract_midi_event_channel(identifier));
+
+				if (is_note_off(event_type)){
+					NoteNumber note = NoteNumber(first_data);
+					auto velocity = io::read<uint8_t>(in);
+					receiver.note_off(duration, channel, note, velocity);
+				}
+				else if(is_note_on(event_type)){
+					NoteNumber note = NoteNumber(first_data);
+					auto velocity = io::read<uint8_t>(in);
+					receiver.note_on(duration, channel, note, velocity);
+				}
+				else if (is_polyphonic_key_pressure(event_type)){
+					NoteNumber note(first_data);
+					auto pressure = io::read<uint8_t>(in);
+					receiver.polyphonic_key_pressure(duration, channel, note, pressure);
+				}
+				else if (is_control_change(event_type)){
+					auto controller = first_data;
+					auto value = io::read<uint8_t>(in);
+					receiver.control_change(duration, channel, controller, value);
+				}
+				else if (is_program_change(event_type)){
+					Instrument program(first_data);
+					receiver.program_change(duration, channel, program);
+				}
+				else if (is_channel_pressure(event_type)){
+					auto pressure = first_data;
+					receiver.channel_pressure(duration, channel, pressure);
+				}
+				else if (is_pitch_wheel_change(event_type)){
+					auto lower_bits = first_data;
+					auto upper_bits = io::read<uint8_t>(in);
+					auto value = upper_bits << 7 | lower_bits;
+					receiver.pitch_wheel_change(duration, channel, value);
+				}
+			}
+			previous_identifier = identifier;
+		}
+	}
+}
+#endif
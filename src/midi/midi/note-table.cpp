@@ -0,0 +1,119 @@
+#include "note-table.h"
+#include "mtrk-reader.h"
+#include <algorithm>
+#include <limits>
+
+namespace midi {
+	namespace {
+		template<typename T>
+		uint64_t latest_end(const std::vector<T>& starts, const std::vector<T>& durations) {
+			uint64_t result = 0;
+			for (size_t i = 0; i < starts.size(); i++){
+				uint64_t end = uint64_t(starts[i]) + durations[i];
+				result = end > result ? end : result;
+			}
+			return result;
+		}
+
+		template<typename INPUT>
+		NoteTable read_notes_columnar_from(INPUT& in) {
+			MTHD mthhead;
+			read_mthd(in, &mthhead);
+			NoteTable table;
+
+			for (int i = 0; i < mthhead.ntracks; i++){
+				NoteCollector collector = NoteCollector([&table](const NOTE& note)
+				{ table.push_back(note); });
+				read_mtrk(in, collector);
+			}
+			return table;
+		}
+	}
+
+	NoteTable::NoteTable(const std::vector<NOTE>& notes) : m_compact(true) {
+		reserve(notes.size());
+		for (const NOTE& note : notes){
+			push_back(note);
+		}
+	}
+
+	void NoteTable::push_back(const NOTE& note) {
+		uint64_t start = value(note.start);
+		uint64_t duration = value(note.duration);
+
+		if (m_compact && start + duration > std::numeric_limits<uint32_t>::max()){
+			widen();
+		}
+		if (m_compact){
+			m_starts32.push_back(uint32_t(start));
+			m_durations32.push_back(uint32_t(duration));
+		}
+		else {
+			m_starts64.push_back(start);
+			m_durations64.push_back(duration);
+		}
+		m_note_numbers.push_back(value(note.note_number));
+		m_velocities.push_back(note.velocity);
+		m_instruments.push_back(value(note.instrument));
+	}
+
+	void NoteTable::reserve(size_t n) {
+		if (m_compact){
+			m_starts32.reserve(n);
+			m_durations32.reserve(n);
+		}
+		else {
+			m_starts64.reserve(n);
+			m_durations64.reserve(n);
+		}
+		m_note_numbers.reserve(n);
+		m_velocities.reserve(n);
+		m_instruments.reserve(n);
+	}
+
+	NOTE NoteTable::operator[](size_t index) const {
+		return NOTE(note_number(index), start(index), duration(index), velocity(index), instrument(index));
+	}
+
+	void NoteTable::widen() {
+		m_starts64.assign(m_starts32.begin(), m_starts32.end());
+		m_durations64.assign(m_durations32.begin(), m_durations32.end());
+		std::vector<uint32_t>().swap(m_starts32);
+		std::vector<uint32_t>().swap(m_durations32);
+		m_starts64.reserve(m_note_numbers.capacity());
+		m_durations64.reserve(m_note_numbers.capacity());
+		m_compact = false;
+	}
+
+	Time NoteTable::end() const {
+		return Time(m_compact ? latest_end(m_starts32, m_durations32) : latest_end(m_starts64, m_durations64));
+	}
+
+	NoteNumber NoteTable::lowest_note() const {
+		if (empty()) return NoteNumber(127);
+		return NoteNumber(*std::min_element(m_note_numbers.begin(), m_note_numbers.end()));
+	}
+
+	NoteNumber NoteTable::highest_note() const {
+		if (empty()) return NoteNumber(0);
+		return NoteNumber(*std::max_element(m_note_numbers.begin(), m_note_numbers.end()));
+	}
+
+	std::vector<NOTE> NoteTable::to_notes() const {
+		std::vector<NOTE> notes;
+		notes.reserve(size());
+		for (size_t i = 0; i < size(); i++){
+			notes.push_back((*this)[i]);
+		}
+		return notes;
+	}
+
+	NoteTable read_notes_columnar(std::istream& in) {
+		return read_notes_columnar_from(in);
+	}
+
+	NoteTable read_notes_columnar(const uint8_t* data, size_t size) {
+		io::ByteCursor in(data, size);
+		return read_notes_columnar_from(in);
+	}
+}
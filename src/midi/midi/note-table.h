@@ -0,0 +1,54 @@
+#ifndef NOTE_TABLE_H
+#define NOTE_TABLE_H
+
+#include "midi.h"
+#include <vector>
+
+namespace midi {
+	// Column-wise (structure of arrays) note storage. Time columns are kept in 32 bits
+	// as long as every start + duration fits, and widened to 64 bits on the first that does not.
+	class NoteTable {
+	public:
+		NoteTable() : m_compact(true) {};
+		explicit NoteTable(const std::vector<NOTE>& notes);
+
+		void push_back(const NOTE& note);
+		void reserve(size_t n);
+		size_t size() const { return m_note_numbers.size(); }
+		bool empty() const { return m_note_numbers.empty(); }
+
+		NOTE operator [](size_t index) const;
+		Time start(size_t index) const { return Time(m_compact ? m_starts32[index] : m_starts64[index]); }
+		Duration duration(size_t index) const { return Duration(m_compact ? m_durations32[index] : m_durations64[index]); }
+		NoteNumber note_number(size_t index) const { return NoteNumber(m_note_numbers[index]); }
+		uint8_t velocity(size_t index) const { return m_velocities[index]; }
+		Instrument instrument(size_t index) const { return Instrument(m_instruments[index]); }
+
+		// True while the time columns are 32 bits wide
+		bool is_compact() const { return m_compact; }
+
+		// Latest start + duration, Time(0) if empty
+		Time end() const;
+		// NoteNumber(127) resp. NoteNumber(0) if empty
+		NoteNumber lowest_note() const;
+		NoteNumber highest_note() const;
+
+		std::vector<NOTE> to_notes() const;
+
+	private:
+		void widen();
+
+		bool m_compact;
+		std::vector<uint64_t> m_starts64;
+		std::vector<uint64_t> m_durations64;
+		std::vector<uint32_t> m_starts32;
+		std::vector<uint32_t> m_durations32;
+		std::vector<uint8_t> m_note_numbers;
+		std::vector<uint8_t> m_velocities;
+		std::vector<uint8_t> m_instruments;
+	};
+
+	NoteTable read_notes_columnar(std::istream&);
+	NoteTable read_notes_columnar(const uint8_t* data, size_t size);
+}
+#endif
@@ -0,0 +1,20 @@
+#include "pitch-index.h"
+
+namespace midi {
+	PitchIndex::PitchIndex(const NoteTable& table) : m_table(table) {
+		std::vector<size_t> rows[128];
+		for (size_t i = 0; i < table.size(); i++){
+			rows[value(table.note_number(i))].push_back(i);
+		}
+		for (int n = 0; n < 128; n++){
+			m_trees[n] = IntervalTree(table, std::move(rows[n]));
+		}
+	}
+
+	std::vector<size_t> PitchIndex::overlapping(NoteNumber note_number, Time from, Time to) const {
+		std::vector<size_t> result;
+		m_trees[value(note_number)].for_each_overlapping_row(from, to, [&result](size_t row)
+		{ result.push_back(row); });
+		return result;
+	}
+}
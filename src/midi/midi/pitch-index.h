@@ -0,0 +1,30 @@
+#ifndef PITCH_INDEX_H
+#define PITCH_INDEX_H
+
+#include "interval-tree.h"
+#include "note-table.h"
+#include <vector>
+
+namespace midi {
+	// Groups the rows of a NoteTable by note number, one IntervalTree per group.
+	// The table must outlive the index.
+	class PitchIndex {
+	public:
+		explicit PitchIndex(const NoteTable& table);
+		explicit PitchIndex(NoteTable&& table) = delete;
+
+		const NoteTable& table() const { return m_table; }
+
+		// Row indices of all notes with the given note number, ordered by start
+		const std::vector<size_t>& notes(NoteNumber note_number) const { return m_trees[value(note_number)].rows(); }
+
+		// Row indices of the notes with the given note number that sound somewhere in [from, to),
+		// ordered by start; O(log n + k) as for IntervalTree
+		std::vector<size_t> overlapping(NoteNumber note_number, Time from, Time to) const;
+
+	private:
+		const NoteTable& m_table;
+		IntervalTree m_trees[128];
+	};
+}
+#endif
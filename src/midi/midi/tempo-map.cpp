@@ -0,0 +1,138 @@
+#include "tempo-map.h"
+#include "mtrk-reader.h"
+#include <algorithm>
+
+namespace midi {
+	namespace {
+		const uint8_t SET_TEMPO = 0x51;
+
+		template<typename INPUT>
+		TempoMap read_tempo_map_from(INPUT& in) {
+			MTHD mthhead;
+			read_mthd(in, &mthhead);
+			std::vector<TempoChange> changes;
+
+			for (int i = 0; i < mthhead.ntracks; i++){
+				TempoCollector collector(changes);
+				read_mtrk(in, collector);
+			}
+			return TempoMap(mthhead.division, std::move(changes));
+		}
+	}
+
+	TempoMap::TempoMap(uint16_t division, std::vector<TempoChange> changes) : m_smpte((division & 0x8000) != 0) {
+		if (m_smpte){
+			int frames_per_second = -int8_t(division >> 8);
+			uint64_t ticks_per_frame = std::max(1, division & 0xFF);
+
+			// One tick lasts 1 / (frames_per_second * ticks_per_frame) seconds; 29 stands for 30000 / 1001
+			if (frames_per_second == 29){
+				m_denominator = 30000 * ticks_per_frame;
+				m_segments.push_back(Segment{ 0, 0, 1000000 * 1001 });
+			}
+			else {
+				m_denominator = uint64_t(std::max(1, frames_per_second)) * ticks_per_frame;
+				m_segments.push_back(Segment{ 0, 0, 1000000 });
+			}
+			return;
+		}
+
+		// Ticks per quarter note; a tick then lasts tempo / division microseconds
+		m_denominator = std::max<uint64_t>(1, division);
+		m_segments.push_back(Segment{ 0, 0, DEFAULT_TEMPO });
+
+		std::stable_sort(changes.begin(), changes.end(), [](const TempoChange& a, const TempoChange& b){
+			return a.time < b.time;
+		});
+
+		for (const TempoChange& change : changes){
+			Segment& last = m_segments.back();
+			uint64_t start = value(change.time);
+			uint64_t rate = std::max<uint32_t>(1, change.microseconds_per_quarter);
+
+			if (start == last.start){
+				last.rate = rate;
+			}
+			else {
+				m_segments.push_back(Segment{ start, last.scaled_start + (start - last.start) * last.rate, rate });
+			}
+		}
+	}
+
+	uint64_t TempoMap::microseconds(Time time) const {
+		uint64_t tick = value(time);
+		auto segment = std::upper_bound(m_segments.begin(), m_segments.end(), tick, [](uint64_t t, const Segment& s){
+			return t < s.start;
+		}) - 1;
+
+		return (segment->scaled_start + (tick - segment->start) * segment->rate) / m_denominator;
+	}
+
+	Time TempoMap::ticks(uint64_t microseconds) const {
+		// microseconds() rounds down, so the tick is the last one whose scaled start is below the next microsecond
+		uint64_t limit = (microseconds + 1) * m_denominator - 1;
+		auto segment = std::upper_bound(m_segments.begin(), m_segments.end(), limit, [](uint64_t t, const Segment& s){
+			return t < s.scaled_start;
+		}) - 1;
+
+		return Time(segment->start + (limit - segment->scaled_start) / segment->rate);
+	}
+
+	void TempoCollector::note_on(Duration dt, Channel, NoteNumber, uint8_t){
+		m_now += dt;
+	}
+
+	void TempoCollector::note_off(Duration dt, Channel, NoteNumber, uint8_t){
+		m_now += dt;
+	}
+
+	void TempoCollector::polyphonic_key_pressure(Duration dt, Channel, NoteNumber, uint8_t){
+		m_now += dt;
+	}
+
+	void TempoCollector::control_change(Duration dt, Channel, uint8_t, uint8_t){
+		m_now += dt;
+	}
+
+	void TempoCollector::program_change(Duration dt, Channel, Instrument){
+		m_now += dt;
+	}
+
+	void TempoCollector::channel_pressure(Duration dt, Channel, uint8_t){
+		m_now += dt;
+	}
+
+	void TempoCollector::pitch_wheel_change(Duration dt, Channel, uint16_t){
+		m_now += dt;
+	}
+
+	void TempoCollector::meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size){
+		meta(dt, type, io::ByteSpan(data.get(), data_size));
+	}
+
+	void TempoCollector::sysex(Duration dt, std::unique_ptr<uint8_t[]>, uint64_t){
+		m_now += dt;
+	}
+
+	void TempoCollector::meta(Duration dt, uint8_t type, io::ByteSpan data){
+		m_now += dt;
+
+		if (type == SET_TEMPO && data.size == 3){
+			uint32_t tempo = uint32_t(data[0]) << 16 | uint32_t(data[1]) << 8 | data[2];
+			m_changes.push_back(TempoChange{ m_now, tempo });
+		}
+	}
+
+	void TempoCollector::sysex(Duration dt, io::ByteSpan){
+		m_now += dt;
+	}
+
+	TempoMap read_tempo_map(std::istream& in){
+		return read_tempo_map_from(in);
+	}
+
+	TempoMap read_tempo_map(const uint8_t* data, size_t size){
+		io::ByteCursor in(data, size);
+		return read_tempo_map_from(in);
+	}
+}
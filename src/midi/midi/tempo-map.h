@@ -0,0 +1,82 @@
+#ifndef TEMPO_MAP_H
+#define TEMPO_MAP_H
+
+#include "midi.h"
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+namespace midi {
+	// Microseconds per quarter note before the first Set Tempo event, i.e. 120 beats per minute
+	const uint32_t DEFAULT_TEMPO = 500000;
+
+	struct TempoChange {
+		Time time;
+		uint32_t microseconds_per_quarter;
+	};
+
+	// Converts between ticks and real time for one MIDI file.
+	//
+	// With a metrical division (ticks per quarter note) the conversion follows the Set Tempo events:
+	// the timeline is cut into segments of constant tempo, their start times are computed once, and
+	// a conversion is a binary search for the segment followed by a multiplication.
+	// With an SMPTE division (negative frames per second in the upper byte, ticks per frame in the lower)
+	// ticks have a fixed length and tempo events do not apply. -29 means 29.97 frames per second.
+	class TempoMap {
+	public:
+		// A constant 120 beats per minute at 96 ticks per quarter note
+		TempoMap() : TempoMap(96, std::vector<TempoChange>()) {};
+
+		// division as found in MTHD; changes in any order, of several at the same time the last one wins
+		TempoMap(uint16_t division, std::vector<TempoChange> changes);
+
+		uint64_t microseconds(Time time) const;
+
+		// Last tick that starts at or before the given moment
+		Time ticks(uint64_t microseconds) const;
+
+		bool is_smpte() const { return m_smpte; }
+
+		// Number of stretches of constant tempo
+		size_t segment_count() const { return m_segments.size(); }
+
+	private:
+		// Times are kept multiplied by m_denominator, which keeps all arithmetic exact
+		struct Segment {
+			uint64_t start;
+			uint64_t scaled_start;
+			uint64_t rate;
+		};
+
+		bool m_smpte;
+		uint64_t m_denominator;
+		std::vector<Segment> m_segments;
+	};
+
+	// Collects the Set Tempo events of one track
+	class TempoCollector final : public EventReceiver {
+	public:
+		explicit TempoCollector(std::vector<TempoChange>& changes) : m_changes(changes), m_now(0) {};
+
+		void note_on(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override;
+		void note_off(Duration dt, Channel channel, NoteNumber note, uint8_t velocity) override;
+		void polyphonic_key_pressure(Duration dt, Channel channel, NoteNumber note, uint8_t pressure) override;
+		void control_change(Duration dt, Channel channel, uint8_t controller, uint8_t value) override;
+		void program_change(Duration dt, Channel channel, Instrument program) override;
+		void channel_pressure(Duration dt, Channel channel, uint8_t pressure) override;
+		void pitch_wheel_change(Duration dt, Channel channel, uint16_t value) override;
+		void meta(Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
+		void sysex(Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) override;
+		void meta(Duration dt, uint8_t type, io::ByteSpan data) override;
+		void sysex(Duration dt, io::ByteSpan data) override;
+
+	private:
+		std::vector<TempoChange>& m_changes;
+		Time m_now;
+	};
+
+	// Tempo map of a whole Standard MIDI File: its division and the Set Tempo events of all tracks
+	TempoMap read_tempo_map(std::istream& in);
+	TempoMap read_tempo_map(const uint8_t* data, size_t size);
+}
+#endif
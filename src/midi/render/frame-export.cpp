@@ -0,0 +1,120 @@
+#include "render/frame-export.h"
+#include "util/parallel.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+using namespace render;
+
+namespace
+{
+    /// <summary>
+    /// Renders frames [0, count), frame i at column position(i); see the export_frames overloads.
+    /// </summary>
+    void export_at(unsigned count, std::function<unsigned(unsigned)> position, unsigned workers, std::function<StreamingRenderer()> create_renderer, std::function<void(unsigned, const StreamingRenderer&)> write)
+    {
+        std::vector<std::unique_ptr<StreamingRenderer>> renderers(resolve_worker_count(workers));
+
+        parallel_for_workers(count, workers, [&](size_t i, unsigned worker) {
+            if (!renderers[worker])
+            {
+                renderers[worker] = std::make_unique<StreamingRenderer>(create_renderer());
+            }
+
+            StreamingRenderer& renderer = *renderers[worker];
+            renderer.move_to(position(unsigned(i)));
+            write(unsigned(i), renderer);
+        });
+    }
+
+    void export_at(unsigned count, std::function<unsigned(unsigned)> position, unsigned workers, std::function<StreamingRenderer()> create_renderer, FrameSink& sink, std::function<void(unsigned)> written)
+    {
+        std::mutex lock;
+        std::condition_variable turn;
+        unsigned next = 0;
+
+        export_at(count, position, workers, create_renderer, [&](unsigned i, const StreamingRenderer& frame) {
+            if (sink.is_sequential())
+            {
+                // Indices are handed out in increasing order, so whoever holds "next" is never waiting
+                std::unique_lock<std::mutex> guard(lock);
+                turn.wait(guard, [&next, i]() { return next == i; });
+
+                sink.write(i, frame);
+                if (written)
+                {
+                    written(i);
+                }
+
+                ++next;
+                turn.notify_all();
+            }
+            else
+            {
+                sink.write(i, frame);
+
+                std::lock_guard<std::mutex> guard(lock);
+                if (written)
+                {
+                    written(i);
+                }
+            }
+        });
+    }
+}
+
+unsigned render::frame_count(unsigned song_width, unsigned frame_width, unsigned step)
+{
+    if (song_width < frame_width || step == 0)
+    {
+        return 0;
+    }
+
+    return (song_width - frame_width) / step + 1;
+}
+
+std::vector<unsigned> render::timed_frame_positions(const midi::TempoMap& tempo, uint32_t scale, unsigned frames_per_second, unsigned song_width, unsigned frame_width)
+{
+    std::vector<unsigned> positions;
+
+    if (song_width < frame_width || frames_per_second == 0 || scale == 0)
+    {
+        return positions;
+    }
+
+    unsigned last = song_width - frame_width;
+
+    for (uint64_t i = 0; ; ++i)
+    {
+        uint64_t column = value(tempo.ticks(i * 1000000 / frames_per_second)) / scale;
+
+        if (column > last)
+        {
+            return positions;
+        }
+
+        positions.push_back(unsigned(column));
+    }
+}
+
+void render::export_frames(unsigned count, unsigned step, unsigned workers, std::function<StreamingRenderer()> create_renderer, std::function<void(unsigned, const StreamingRenderer&)> write)
+{
+    export_at(count, [step](unsigned i) { return i * step; }, workers, create_renderer, write);
+}
+
+void render::export_frames(unsigned count, unsigned step, unsigned workers, std::function<StreamingRenderer()> create_renderer, FrameSink& sink, std::function<void(unsigned)> written)
+{
+    export_at(count, [step](unsigned i) { return i * step; }, workers, create_renderer, sink, written);
+}
+
+void render::export_frames(const std::vector<unsigned>& positions, unsigned workers, std::function<StreamingRenderer()> create_renderer, std::function<void(unsigned, const StreamingRenderer&)> write)
+{
+    export_at(unsigned(positions.size()), [&positions](unsigned i) { return positions[i]; }, workers, create_renderer, write);
+}
+
+void render::export_frames(const std::vector<unsigned>& positions, unsigned workers, std::function<StreamingRenderer()> create_renderer, FrameSink& sink, std::function<void(unsigned)> written)
+{
+    export_at(unsigned(positions.size()), [&positions](unsigned i) { return positions[i]; }, workers, create_renderer, sink, written);
+}
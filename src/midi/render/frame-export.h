@@ -0,0 +1,56 @@
+#ifndef FRAME_EXPORT_H
+#define FRAME_EXPORT_H
+
+#include "imaging/bitmap.h"
+#include "render/frame-sink.h"
+#include "render/streaming-renderer.h"
+#include "midi/tempo-map.h"
+#include <functional>
+#include <vector>
+
+
+namespace render
+{
+    /// <summary>
+    /// Number of frames a window of <paramref name="frame_width" /> columns produces when it
+    /// slides over <paramref name="song_width" /> columns, <paramref name="step" /> at a time.
+    /// </summary>
+    unsigned frame_count(unsigned song_width, unsigned frame_width, unsigned step);
+
+    /// <summary>
+    /// Window positions for exporting at a fixed frame rate: frame i starts at the column that is playing
+    /// i / <paramref name="frames_per_second" /> seconds into the song, according to <paramref name="tempo" />,
+    /// with <paramref name="scale" /> ticks per column. Like <see cref="frame_count" />, frames stop once the
+    /// window would run past the end of the song. Consecutive frames may share a position or skip columns,
+    /// depending on the tempo.
+    /// </summary>
+    std::vector<unsigned> timed_frame_positions(const midi::TempoMap& tempo, uint32_t scale, unsigned frames_per_second, unsigned song_width, unsigned frame_width);
+
+    /// <summary>
+    /// Renders frames [0, count), frame i showing the window that starts at column i * step,
+    /// and passes each of them to <paramref name="write" /> together with its index, as a renderer
+    /// positioned at that frame (use <see cref="StreamingRenderer::write_bmp" /> or
+    /// <see cref="StreamingRenderer::frame" />).
+    /// Frames are spread over <paramref name="workers" /> threads (0: one per core), every worker
+    /// rendering with its own renderer from <paramref name="create_renderer" /> and writing its own
+    /// frames, so <paramref name="write" /> is called concurrently and in no particular order.
+    /// At most one frame per worker is in flight.
+    /// </summary>
+    void export_frames(unsigned count, unsigned step, unsigned workers, std::function<StreamingRenderer()> create_renderer, std::function<void(unsigned, const StreamingRenderer&)> write);
+
+    /// <summary>
+    /// Renders frames as above and writes them to <paramref name="sink" />. Rendering always runs
+    /// on all workers; for a sequential sink the writes are then taken in turn, in index order.
+    /// <paramref name="written" />, if given, is called after each write, one call at a time.
+    /// </summary>
+    void export_frames(unsigned count, unsigned step, unsigned workers, std::function<StreamingRenderer()> create_renderer, FrameSink& sink, std::function<void(unsigned)> written = nullptr);
+
+    /// <summary>
+    /// Same as the overloads above, frame i showing the window that starts at column positions[i].
+    /// Only these frames are rendered.
+    /// </summary>
+    void export_frames(const std::vector<unsigned>& positions, unsigned workers, std::function<StreamingRenderer()> create_renderer, std::function<void(unsigned, const StreamingRenderer&)> write);
+    void export_frames(const std::vector<unsigned>& positions, unsigned workers, std::function<StreamingRenderer()> create_renderer, FrameSink& sink, std::function<void(unsigned)> written = nullptr);
+}
+
+#endif
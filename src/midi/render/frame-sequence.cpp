@@ -0,0 +1,192 @@
+#include "render/frame-sequence.h"
+#include "io/deflate.h"
+#include "io/inflate.h"
+#include "logging.h"
+#include <algorithm>
+#include <cstring>
+
+
+using namespace render;
+
+namespace
+{
+    const char MAGIC[] = { 'P', 'R', 'S', 'Q' };
+    const uint16_t VERSION = 1;
+    const uint16_t HEADER_SIZE = 16;
+    const size_t RECORD_HEADER_SIZE = 9;
+
+    void put_uint16(std::vector<uint8_t>& buffer, uint16_t value)
+    {
+        buffer.push_back(uint8_t(value));
+        buffer.push_back(uint8_t(value >> 8));
+    }
+
+    void put_uint32(std::vector<uint8_t>& buffer, uint32_t value)
+    {
+        for (int shift = 0; shift != 32; shift += 8)
+        {
+            buffer.push_back(uint8_t(value >> shift));
+        }
+    }
+
+    uint32_t get_uint(const uint8_t* bytes, unsigned size)
+    {
+        uint32_t result = 0;
+
+        for (unsigned i = size; i-- > 0; )
+        {
+            result = (result << 8) | bytes[i];
+        }
+
+        return result;
+    }
+
+    /// <summary>
+    /// Reads and checks the header, and returns a black frame of the size it announces.
+    /// </summary>
+    imaging::PackedBitmap read_header(std::istream& in)
+    {
+        uint8_t header[HEADER_SIZE];
+        in.read(reinterpret_cast<char*>(header), sizeof(header));
+
+        CHECK(in.gcount() == HEADER_SIZE && std::memcmp(header, MAGIC, sizeof(MAGIC)) == 0) << "Not a piano roll sequence";
+        CHECK(get_uint(header + 4, 2) == VERSION) << "Unsupported sequence version " << get_uint(header + 4, 2);
+
+        uint32_t header_size = get_uint(header + 6, 2);
+        CHECK(header_size >= HEADER_SIZE) << "Invalid sequence header size";
+        in.ignore(header_size - HEADER_SIZE);
+
+        return imaging::PackedBitmap(get_uint(header + 8, 4), get_uint(header + 12, 4));
+    }
+}
+
+SequenceSink::SequenceSink(std::ostream& out, int level, unsigned keyframe_interval)
+    : m_out(out)
+    , m_level(level)
+    , m_keyframe_interval(keyframe_interval)
+    , m_header_written(false)
+    , m_previous_position(0)
+    , m_since_keyframe(0)
+{
+    // NOP
+}
+
+bool SequenceSink::is_sequential() const
+{
+    return true;
+}
+
+void SequenceSink::write(unsigned, const StreamingRenderer& frame)
+{
+    unsigned width = frame.width();
+    unsigned position = frame.position();
+    bool keyframe = !m_header_written
+        || position < m_previous_position
+        || position - m_previous_position >= width
+        || (m_keyframe_interval != 0 && m_since_keyframe + 1 >= m_keyframe_interval);
+
+    if (!m_header_written)
+    {
+        std::vector<uint8_t> header(MAGIC, MAGIC + sizeof(MAGIC));
+        put_uint16(header, VERSION);
+        put_uint16(header, HEADER_SIZE);
+        put_uint32(header, width);
+        put_uint32(header, frame.height());
+
+        m_out.write(reinterpret_cast<const char*>(header.data()), header.size());
+        m_header_written = true;
+    }
+
+    unsigned shift = keyframe ? 0 : position - m_previous_position;
+    unsigned columns = keyframe ? width : shift;
+
+    m_payload.clear();
+    m_row.resize(width);
+
+    io::Deflater deflater(m_level, [this](const uint8_t* data, size_t size) {
+        m_payload.insert(m_payload.end(), data, data + size);
+    });
+
+    for (unsigned y = 0; y != frame.height(); ++y)
+    {
+        frame.copy_row(y, m_row.data());
+        deflater.write(reinterpret_cast<const uint8_t*>(m_row.data() + width - columns), sizeof(imaging::PackedColor) * columns);
+    }
+
+    deflater.finish();
+
+    std::vector<uint8_t> record;
+    record.push_back(keyframe ? sequence::KEYFRAME : sequence::DELTA);
+    put_uint32(record, shift);
+    put_uint32(record, uint32_t(m_payload.size()));
+
+    m_out.write(reinterpret_cast<const char*>(record.data()), record.size());
+    m_out.write(reinterpret_cast<const char*>(m_payload.data()), m_payload.size());
+
+    m_previous_position = position;
+    m_since_keyframe = keyframe ? 0 : m_since_keyframe + 1;
+}
+
+SequenceReader::SequenceReader(std::istream& in)
+    : m_in(in)
+    , m_frame(read_header(in))
+    , m_has_frame(false)
+{
+    // NOP
+}
+
+unsigned SequenceReader::width() const
+{
+    return m_frame.width();
+}
+
+unsigned SequenceReader::height() const
+{
+    return m_frame.height();
+}
+
+const imaging::PackedBitmap& SequenceReader::frame() const
+{
+    return m_frame;
+}
+
+bool SequenceReader::next()
+{
+    uint8_t record[RECORD_HEADER_SIZE];
+    m_in.read(reinterpret_cast<char*>(record), sizeof(record));
+
+    if (m_in.gcount() == 0)
+    {
+        return false;
+    }
+
+    CHECK(m_in.gcount() == RECORD_HEADER_SIZE) << "Truncated sequence record";
+
+    uint8_t type = record[0];
+    unsigned shift = get_uint(record + 1, 4);
+    std::vector<uint8_t> payload(get_uint(record + 5, 4));
+    m_in.read(reinterpret_cast<char*>(payload.data()), payload.size());
+
+    CHECK(size_t(m_in.gcount()) == payload.size()) << "Truncated sequence record";
+    CHECK(type == sequence::KEYFRAME || type == sequence::DELTA) << "Unknown sequence record type " << unsigned(type);
+    CHECK(type == sequence::KEYFRAME || (m_has_frame && shift < width())) << "Invalid delta frame";
+
+    unsigned columns = type == sequence::KEYFRAME ? width() : shift;
+    std::vector<uint8_t> pixels = io::inflate(payload.data(), payload.size());
+    CHECK(pixels.size() == sizeof(imaging::PackedColor) * columns * height()) << "Sequence frame has the wrong size";
+
+    auto view = m_frame.view();
+    const imaging::PackedColor* source = reinterpret_cast<const imaging::PackedColor*>(pixels.data());
+
+    for (unsigned y = 0; y != height(); ++y)
+    {
+        imaging::PackedColor* row = view.row(y);
+
+        std::copy(row + columns, row + width(), row);
+        std::copy(source + size_t(y) * columns, source + size_t(y + 1) * columns, row + width() - columns);
+    }
+
+    m_has_frame = true;
+
+    return true;
+}
@@ -0,0 +1,100 @@
+#ifndef FRAME_SEQUENCE_H
+#define FRAME_SEQUENCE_H
+
+#include "render/frame-sink.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+namespace render
+{
+    /// <summary>
+    /// Piano roll sequence (.prs) files hold a whole run of frames in one file.
+    /// The window only ever slides right, so a frame is the previous one shifted left
+    /// plus a few new columns on the right, and only those columns are stored.
+    ///
+    /// All integers are little endian. The file starts with a 16 byte header:
+    ///
+    ///     char[4]  magic          "PRSQ"
+    ///     uint16   version        1
+    ///     uint16   header size    16
+    ///     uint32   width          in pixels
+    ///     uint32   height         in pixels
+    ///
+    /// followed by one record per frame, up to the end of the file:
+    ///
+    ///     uint8    type           0 = keyframe, 1 = delta
+    ///     uint32   shift          delta: columns the window moved right since the previous frame, less than width;
+    ///                             keyframe: 0
+    ///     uint32   size           of the payload in bytes
+    ///     payload                 zlib stream of BGRA pixels, row by row from the top, each row holding
+    ///                             all columns of a keyframe or the rightmost shift columns of a delta
+    /// </summary>
+    namespace sequence
+    {
+        const uint8_t KEYFRAME = 0;
+        const uint8_t DELTA = 1;
+
+        const int DEFAULT_LEVEL = 6;
+    }
+
+    /// <summary>
+    /// Appends all frames to a single sequence stream (see <see cref="sequence" />).
+    /// A frame is stored as a delta whenever the window moved right by less than its width
+    /// since the previous frame, and as a keyframe otherwise.
+    /// </summary>
+    class SequenceSink final : public FrameSink
+    {
+    public:
+        /// <summary>
+        /// The stream must outlive the sink. <paramref name="level" /> is the zlib level of the payloads.
+        /// A nonzero <paramref name="keyframe_interval" /> forces a keyframe at least every that many frames,
+        /// so a decoder can start part way through; with zero only the first frame is a keyframe.
+        /// </summary>
+        SequenceSink(std::ostream& out, int level = sequence::DEFAULT_LEVEL, unsigned keyframe_interval = 0);
+
+        bool is_sequential() const override;
+        void write(unsigned index, const StreamingRenderer& frame) override;
+
+    private:
+        std::ostream& m_out;
+        int m_level;
+        unsigned m_keyframe_interval;
+        bool m_header_written;
+        unsigned m_previous_position;
+        unsigned m_since_keyframe;
+        std::vector<imaging::PackedColor> m_row;
+        std::vector<uint8_t> m_payload;
+    };
+
+    /// <summary>
+    /// Reads a sequence stream back, one frame at a time.
+    /// </summary>
+    class SequenceReader final
+    {
+    public:
+        /// <summary>
+        /// Reads the header. The stream must outlive the reader.
+        /// </summary>
+        explicit SequenceReader(std::istream& in);
+
+        /// <summary>
+        /// Decodes the next frame into <see cref="frame" />.
+        /// Returns false, leaving the frame untouched, at the end of the stream.
+        /// </summary>
+        bool next();
+
+        const imaging::PackedBitmap& frame() const;
+
+        unsigned width() const;
+        unsigned height() const;
+
+    private:
+        std::istream& m_in;
+        imaging::PackedBitmap m_frame;
+        bool m_has_frame;
+    };
+}
+
+#endif
@@ -0,0 +1,95 @@
+#include "render/frame-sink.h"
+#include "logging.h"
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+
+
+using namespace render;
+
+namespace
+{
+    /// <summary>
+    /// Lets <paramref name="encode" /> write a file, either directly or, given a <paramref name="writer" />,
+    /// into memory to be written by the writer's I/O thread.
+    /// </summary>
+    void write_file(io::AsyncFileWriter* writer, const std::string& path, std::function<void(std::ostream&)> encode)
+    {
+        if (writer == nullptr)
+        {
+            std::ofstream out(path, std::ios::binary);
+            encode(out);
+        }
+        else
+        {
+            std::ostringstream out;
+            encode(out);
+            writer->write(path, out.str());
+        }
+    }
+}
+
+bool render::is_frame_pattern(const std::string& pattern)
+{
+    return pattern.find("%d") != std::string::npos;
+}
+
+std::string render::frame_path(const std::string& pattern, unsigned index)
+{
+    CHECK(is_frame_pattern(pattern)) << "Output pattern " << pattern << " has no %d placeholder";
+
+    std::stringstream counter;
+    counter << std::setfill('0') << std::setw(5) << index;
+
+    std::string result = pattern;
+    result.replace(result.find("%d"), 2, counter.str());
+
+    return result;
+}
+
+BmpFileSink::BmpFileSink(const std::string& pattern, imaging::BmpCompression compression, io::AsyncFileWriter* writer)
+    : m_pattern(pattern)
+    , m_compression(compression)
+    , m_writer(writer)
+{
+    CHECK(is_frame_pattern(pattern)) << "Output pattern " << pattern << " has no %d placeholder";
+}
+
+bool BmpFileSink::is_sequential() const
+{
+    return false;
+}
+
+std::string BmpFileSink::path(unsigned index) const
+{
+    return frame_path(m_pattern, index);
+}
+
+void BmpFileSink::write(unsigned index, const StreamingRenderer& frame)
+{
+    write_file(m_writer, path(index), [this, &frame](std::ostream& out) { frame.write_bmp(out, m_compression); });
+}
+
+PngFileSink::PngFileSink(const std::string& pattern, int level, io::AsyncFileWriter* writer)
+    : m_pattern(pattern)
+    , m_level(level)
+    , m_writer(writer)
+{
+    CHECK(is_frame_pattern(pattern)) << "Output pattern " << pattern << " has no %d placeholder";
+}
+
+bool PngFileSink::is_sequential() const
+{
+    return false;
+}
+
+std::string PngFileSink::path(unsigned index) const
+{
+    return frame_path(m_pattern, index);
+}
+
+void PngFileSink::write(unsigned index, const StreamingRenderer& frame)
+{
+    write_file(m_writer, path(index), [this, &frame](std::ostream& out) { frame.write_png(out, m_level); });
+}
@@ -0,0 +1,91 @@
+#ifndef FRAME_SINK_H
+#define FRAME_SINK_H
+
+#include "render/streaming-renderer.h"
+#include "io/async-file-writer.h"
+#include <string>
+
+
+namespace render
+{
+    /// <summary>
+    /// Destination of rendered frames.
+    /// </summary>
+    class FrameSink
+    {
+    public:
+        virtual ~FrameSink() { }
+
+        /// <summary>
+        /// True if frames have to be written one at a time and in index order,
+        /// e.g. because they are appended to a single stream.
+        /// Otherwise <see cref="write" /> may be called concurrently, in any order.
+        /// </summary>
+        virtual bool is_sequential() const = 0;
+
+        /// <summary>
+        /// Writes frame <paramref name="index" />, i.e. the current window of <paramref name="frame" />.
+        /// </summary>
+        virtual void write(unsigned index, const StreamingRenderer& frame) = 0;
+    };
+
+    /// <summary>
+    /// True if <paramref name="pattern" /> contains the "%d" placeholder <see cref="frame_path" /> needs;
+    /// without it every frame would be written to the same file.
+    /// </summary>
+    bool is_frame_pattern(const std::string& pattern);
+
+    /// <summary>
+    /// Replaces "%d" in <paramref name="pattern" /> by <paramref name="index" />, zero-padded to five digits.
+    /// The pattern must contain the placeholder.
+    /// </summary>
+    std::string frame_path(const std::string& pattern, unsigned index);
+
+    /// <summary>
+    /// Writes every frame to its own BMP file, named after a pattern in which
+    /// "%d" is replaced by the frame index, zero-padded to five digits.
+    /// </summary>
+    class BmpFileSink final : public FrameSink
+    {
+    public:
+        /// <summary>
+        /// Without a <paramref name="writer" />, each file is written by the thread that rendered the frame.
+        /// With one, frames are encoded into memory and handed to its I/O thread, so rendering the next frame
+        /// overlaps writing this one. The writer must outlive the sink.
+        /// </summary>
+        explicit BmpFileSink(const std::string& pattern, imaging::BmpCompression compression = imaging::BmpCompression::None, io::AsyncFileWriter* writer = nullptr);
+
+        bool is_sequential() const override;
+        void write(unsigned index, const StreamingRenderer& frame) override;
+
+        std::string path(unsigned index) const;
+
+    private:
+        std::string m_pattern;
+        imaging::BmpCompression m_compression;
+        io::AsyncFileWriter* m_writer;
+    };
+
+    /// <summary>
+    /// Writes every frame to its own PNG file, named like the files of <see cref="BmpFileSink" />.
+    /// Frames are compressed on the exporting workers, so compression runs in parallel.
+    /// An optional <paramref name="writer" /> takes the file writes off those workers, as for <see cref="BmpFileSink" />.
+    /// </summary>
+    class PngFileSink final : public FrameSink
+    {
+    public:
+        explicit PngFileSink(const std::string& pattern, int level = imaging::DEFAULT_PNG_LEVEL, io::AsyncFileWriter* writer = nullptr);
+
+        bool is_sequential() const override;
+        void write(unsigned index, const StreamingRenderer& frame) override;
+
+        std::string path(unsigned index) const;
+
+    private:
+        std::string m_pattern;
+        int m_level;
+        io::AsyncFileWriter* m_writer;
+    };
+}
+
+#endif
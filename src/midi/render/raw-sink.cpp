@@ -0,0 +1,76 @@
+#include "render/raw-sink.h"
+
+
+using namespace render;
+
+RawSink::RawSink(std::ostream& out, Format format, size_t buffer_size)
+    : m_out(out)
+    , m_format(format)
+    , m_buffer(buffer_size)
+    , m_used(0)
+{
+    // NOP
+}
+
+RawSink::~RawSink()
+{
+    flush();
+}
+
+bool RawSink::is_sequential() const
+{
+    return true;
+}
+
+uint8_t* RawSink::reserve(size_t size)
+{
+    if (m_used + size > m_buffer.size())
+    {
+        m_out.write(reinterpret_cast<const char*>(m_buffer.data()), m_used);
+        m_used = 0;
+
+        if (size > m_buffer.size())
+        {
+            m_buffer.resize(size);
+        }
+    }
+
+    uint8_t* result = m_buffer.data() + m_used;
+    m_used += size;
+
+    return result;
+}
+
+void RawSink::write(unsigned, const StreamingRenderer& frame)
+{
+    unsigned width = frame.width();
+
+    for (unsigned y = 0; y != frame.height(); ++y)
+    {
+        if (m_format == Format::BGRA)
+        {
+            frame.copy_row(y, reinterpret_cast<imaging::PackedColor*>(reserve(sizeof(imaging::PackedColor) * width)));
+        }
+        else
+        {
+            m_row.resize(width);
+            frame.copy_row(y, m_row.data());
+
+            uint8_t* out = reserve(3 * size_t(width));
+
+            for (const imaging::PackedColor& c : m_row)
+            {
+                *out++ = c.r;
+                *out++ = c.g;
+                *out++ = c.b;
+            }
+        }
+    }
+}
+
+void RawSink::flush()
+{
+    m_out.write(reinterpret_cast<const char*>(m_buffer.data()), m_used);
+    m_used = 0;
+    m_out.flush();
+}
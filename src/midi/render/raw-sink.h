@@ -0,0 +1,66 @@
+#ifndef RAW_SINK_H
+#define RAW_SINK_H
+
+#include "render/frame-sink.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+namespace render
+{
+    /// <summary>
+    /// Appends the pixels of all frames, without any header, to a single stream:
+    /// frame after frame, rows top to bottom, in the chosen byte order. Meant to be piped
+    /// into an external encoder (e.g. ffmpeg -f rawvideo -pixel_format bgra -video_size WxH -i -).
+    /// Output is collected in a large buffer and handed to the stream in big writes.
+    /// </summary>
+    class RawSink final : public FrameSink
+    {
+    public:
+        enum class Format
+        {
+            /// <summary>
+            /// 4 bytes per pixel: blue, green, red, alpha. Copied straight from the renderer.
+            /// </summary>
+            BGRA,
+
+            /// <summary>
+            /// 3 bytes per pixel: red, green, blue.
+            /// </summary>
+            RGB
+        };
+
+        /// <summary>
+        /// The stream must outlive the sink. The buffer grows to hold at least one row.
+        /// </summary>
+        RawSink(std::ostream& out, Format format, size_t buffer_size = 1 << 22);
+
+        /// <summary>
+        /// Flushes what is still buffered.
+        /// </summary>
+        ~RawSink();
+
+        RawSink(const RawSink&) = delete;
+        RawSink& operator =(const RawSink&) = delete;
+
+        bool is_sequential() const override;
+        void write(unsigned index, const StreamingRenderer& frame) override;
+
+        /// <summary>
+        /// Hands everything buffered so far to the stream and flushes it.
+        /// </summary>
+        void flush();
+
+    private:
+        uint8_t* reserve(size_t size);
+
+        std::ostream& m_out;
+        Format m_format;
+        std::vector<uint8_t> m_buffer;
+        size_t m_used;
+        std::vector<imaging::PackedColor> m_row;
+    };
+}
+
+#endif
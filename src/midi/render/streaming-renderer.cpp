@@ -0,0 +1,142 @@
+#include "render/streaming-renderer.h"
+#include <algorithm>
+
+
+using namespace render;
+
+namespace
+{
+    unsigned row_count(int low, int high, uint32_t note_height)
+    {
+        return high >= low ? unsigned(high - low + 1) * note_height : 0;
+    }
+
+    /// <summary>
+    /// Fills rows [top, bottom) of the ring columns that hold the song columns [from, to).
+    /// At most one frame width of columns, which wraps around at most once.
+    /// </summary>
+    void fill_columns(imaging::PackedBitmap& ring, uint64_t from, uint64_t to, unsigned top, unsigned bottom, const imaging::PackedColor& color)
+    {
+        unsigned first = unsigned(from % ring.width());
+        unsigned count = unsigned(to - from);
+        unsigned head = std::min(count, ring.width() - first);
+
+        ring.fill_rect(first, top, head, bottom - top, color);
+        ring.fill_rect(0, top, count - head, bottom - top, color);
+    }
+}
+
+StreamingRenderer::StreamingRenderer(const midi::IntervalTree& notes, uint32_t scale, uint32_t note_height, midi::NoteNumber low, midi::NoteNumber high, unsigned frame_width)
+    : m_notes(notes)
+    , m_scale(scale)
+    , m_note_height(note_height)
+    , m_low(value(low))
+    , m_high(value(high))
+    , m_ring(frame_width, row_count(value(low), value(high), note_height))
+    , m_left(0)
+    , m_valid(false)
+{
+    // NOP
+}
+
+unsigned StreamingRenderer::width() const
+{
+    return m_ring.width();
+}
+
+unsigned StreamingRenderer::height() const
+{
+    return m_ring.height();
+}
+
+unsigned StreamingRenderer::position() const
+{
+    return m_left;
+}
+
+void StreamingRenderer::move_to(unsigned x)
+{
+    unsigned right = m_left + width();
+
+    if (m_valid && x >= m_left && x < right)
+    {
+        draw_columns(right, x + width());
+    }
+    else
+    {
+        draw_columns(x, x + width());
+    }
+
+    m_left = x;
+    m_valid = true;
+}
+
+void StreamingRenderer::draw_columns(unsigned from, unsigned to)
+{
+    if (from >= to)
+    {
+        return;
+    }
+
+    fill_columns(m_ring, from, to, 0, height(), imaging::PackedColor());
+
+    midi::Time first(uint64_t(from) * m_scale);
+    midi::Time last(uint64_t(to) * m_scale);
+
+    m_notes.for_each_overlapping(first, last, [this, from, to](const midi::NOTE& note) {
+        int n = value(note.note_number);
+
+        if (n < m_low || n > m_high)
+        {
+            return;
+        }
+
+        uint64_t start = value(note.start) / m_scale;
+        uint64_t end = start + value(note.duration) / m_scale;
+        uint64_t left = std::max<uint64_t>(start, from);
+        uint64_t right = std::min<uint64_t>(end, to);
+        unsigned top = unsigned(m_high - n) * m_note_height;
+
+        if (left < right)
+        {
+            fill_columns(m_ring, left, right, top, top + m_note_height, imaging::PackedColor(imaging::colors::cyan()));
+        }
+    });
+}
+
+imaging::PackedBitmap StreamingRenderer::frame() const
+{
+    imaging::PackedBitmap result(width(), height());
+    auto pixels = result.view();
+
+    for (unsigned y = 0; y != height(); ++y)
+    {
+        copy_row(y, pixels.row(y));
+    }
+
+    return result;
+}
+
+void StreamingRenderer::copy_row(unsigned y, imaging::PackedColor* out) const
+{
+    if (width() == 0)
+    {
+        return;
+    }
+
+    const imaging::PackedColor* source = m_ring.view().row(y);
+    unsigned split = m_left % width();
+
+    out = std::copy(source + split, source + width(), out);
+    std::copy(source, source + split, out);
+}
+
+void StreamingRenderer::write_bmp(std::ostream& out, imaging::BmpCompression compression) const
+{
+    imaging::save_as_bmp(out, m_ring, width() == 0 ? 0 : m_left % width(), compression);
+}
+
+void StreamingRenderer::write_png(std::ostream& out, int level) const
+{
+    imaging::save_as_png(out, m_ring, width() == 0 ? 0 : m_left % width(), level);
+}
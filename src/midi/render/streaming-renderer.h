@@ -0,0 +1,84 @@
+#ifndef STREAMING_RENDERER_H
+#define STREAMING_RENDERER_H
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "imaging/png-format.h"
+#include "midi/interval-tree.h"
+#include <cstdint>
+#include <iostream>
+
+
+namespace render
+{
+    /// <summary>
+    /// Renders the piano roll one frame at a time. Only a frame-wide ring buffer of
+    /// columns is kept: column x lives at x % frame_width, and when the window moves
+    /// forward only the newly revealed columns are drawn, from notes queried in the
+    /// interval tree. Memory is bounded by the frame size instead of the song length.
+    ///
+    /// Pixel layout matches the full-song rendering: a note covers the columns
+    /// [start / scale, start / scale + duration / scale) and the rows of its note number,
+    /// with <paramref name="high" /> at the top and <paramref name="low" /> at the bottom.
+    /// </summary>
+    class StreamingRenderer final
+    {
+    public:
+        /// <summary>
+        /// The tree must outlive the renderer.
+        /// </summary>
+        StreamingRenderer(const midi::IntervalTree& notes, uint32_t scale, uint32_t note_height, midi::NoteNumber low, midi::NoteNumber high, unsigned frame_width);
+
+        /// <summary>
+        /// Moves the window so that its leftmost column is <paramref name="x" />.
+        /// Moving forward by less than a frame only draws the columns that came into view;
+        /// any other move redraws the whole window.
+        /// </summary>
+        void move_to(unsigned x);
+
+        /// <summary>
+        /// Copies the current window, left to right, into a new bitmap.
+        /// </summary>
+        imaging::PackedBitmap frame() const;
+
+        /// <summary>
+        /// Writes the current window as a BMP file straight from the ring buffer.
+        /// Together with <see cref="move_to" /> this makes the work per frame, apart from
+        /// writing out its bytes, proportional to the number of new columns.
+        /// </summary>
+        void write_bmp(std::ostream& out, imaging::BmpCompression compression = imaging::BmpCompression::None) const;
+
+        /// <summary>
+        /// Writes the current window as a PNG file straight from the ring buffer.
+        /// </summary>
+        void write_png(std::ostream& out, int level = imaging::DEFAULT_PNG_LEVEL) const;
+
+        /// <summary>
+        /// Copies row <paramref name="y" /> of the current window, left to right, to <paramref name="out" />,
+        /// which must have room for <see cref="width" /> pixels.
+        /// </summary>
+        void copy_row(unsigned y, imaging::PackedColor* out) const;
+
+        unsigned width() const;
+        unsigned height() const;
+
+        /// <summary>
+        /// Leftmost column of the current window, as last passed to <see cref="move_to" />.
+        /// </summary>
+        unsigned position() const;
+
+    private:
+        void draw_columns(unsigned from, unsigned to);
+
+        const midi::IntervalTree& m_notes;
+        uint32_t m_scale;
+        uint32_t m_note_height;
+        int m_low;
+        int m_high;
+        imaging::PackedBitmap m_ring;
+        unsigned m_left;
+        bool m_valid;
+    };
+}
+
+#endif
@@ -0,0 +1,72 @@
+#include "render/y4m-sink.h"
+
+
+using namespace render;
+
+namespace
+{
+    uint8_t luma(const imaging::PackedColor& c)
+    {
+        return uint8_t(((66 * c.r + 129 * c.g + 25 * c.b + 128) >> 8) + 16);
+    }
+
+    uint8_t blue_difference(const imaging::PackedColor& c)
+    {
+        return uint8_t(((-38 * c.r - 74 * c.g + 112 * c.b + 128) >> 8) + 128);
+    }
+
+    uint8_t red_difference(const imaging::PackedColor& c)
+    {
+        return uint8_t(((112 * c.r - 94 * c.g - 18 * c.b + 128) >> 8) + 128);
+    }
+}
+
+Y4mSink::Y4mSink(std::ostream& out, unsigned frames_per_second)
+    : m_out(out)
+    , m_frames_per_second(frames_per_second)
+    , m_header_written(false)
+{
+    // NOP
+}
+
+bool Y4mSink::is_sequential() const
+{
+    return true;
+}
+
+void Y4mSink::write(unsigned, const StreamingRenderer& frame)
+{
+    unsigned width = frame.width();
+    unsigned height = frame.height();
+    size_t plane = size_t(width) * height;
+
+    if (!m_header_written)
+    {
+        m_out << "YUV4MPEG2 W" << width << " H" << height << " F" << m_frames_per_second << ":1 Ip A1:1 C444\n";
+        m_header_written = true;
+    }
+
+    m_row.resize(width);
+    m_planes.resize(3 * plane);
+
+    uint8_t* y_plane = m_planes.data();
+    uint8_t* u_plane = y_plane + plane;
+    uint8_t* v_plane = u_plane + plane;
+
+    for (unsigned y = 0; y != height; ++y)
+    {
+        frame.copy_row(y, m_row.data());
+
+        for (unsigned x = 0; x != width; ++x)
+        {
+            size_t i = size_t(y) * width + x;
+
+            y_plane[i] = luma(m_row[x]);
+            u_plane[i] = blue_difference(m_row[x]);
+            v_plane[i] = red_difference(m_row[x]);
+        }
+    }
+
+    m_out << "FRAME\n";
+    m_out.write(reinterpret_cast<const char*>(m_planes.data()), m_planes.size());
+}
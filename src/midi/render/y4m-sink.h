@@ -0,0 +1,37 @@
+#ifndef Y4M_SINK_H
+#define Y4M_SINK_H
+
+#include "render/frame-sink.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+
+namespace render
+{
+    /// <summary>
+    /// Appends all frames to a single YUV4MPEG2 (.y4m) stream, which video encoders
+    /// such as ffmpeg read directly. Frames are stored uncompressed as full resolution
+    /// (4:4:4) BT.601 studio range YUV. The stream header is written with the first frame.
+    /// </summary>
+    class Y4mSink final : public FrameSink
+    {
+    public:
+        /// <summary>
+        /// The stream must outlive the sink.
+        /// </summary>
+        Y4mSink(std::ostream& out, unsigned frames_per_second);
+
+        bool is_sequential() const override;
+        void write(unsigned index, const StreamingRenderer& frame) override;
+
+    private:
+        std::ostream& m_out;
+        unsigned m_frames_per_second;
+        bool m_header_written;
+        std::vector<imaging::PackedColor> m_row;
+        std::vector<uint8_t> m_planes;
+    };
+}
+
+#endif
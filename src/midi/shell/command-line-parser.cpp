@@ -69,7 +69,8 @@ void CommandLineParser::process(std::list<std::string>& arguments)
         auto head = arguments.front();
         arguments.pop_front();
 
-        if (head[0] == '-')
+        // A lone "-" is positional, by convention it stands for stdin or stdout
+        if (head.size() > 1 && head[0] == '-')
         {
             auto it = m_map.find(head);
 
@@ -0,0 +1,222 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "io/vli.h"
+#include "Catch.h"
+#include <random>
+#include <sstream>
+#include <vector>
+
+
+namespace
+{
+    std::vector<uint8_t> encode(uint64_t value)
+    {
+        std::vector<uint8_t> result;
+        result.push_back(value & 0x7F);
+        value >>= 7;
+
+        while (value != 0)
+        {
+            result.insert(result.begin(), uint8_t(0x80 | (value & 0x7F)));
+            value >>= 7;
+        }
+
+        return result;
+    }
+
+    std::vector<uint8_t> encode_all(const std::vector<uint64_t>& values)
+    {
+        std::vector<uint8_t> result;
+
+        for (auto value : values)
+        {
+            auto bytes = encode(value);
+            result.insert(result.end(), bytes.begin(), bytes.end());
+        }
+
+        return result;
+    }
+
+    std::vector<uint64_t> random_delta_times(size_t count)
+    {
+        std::mt19937_64 generator(42);
+        std::vector<uint64_t> result;
+
+        for (size_t i = 0; i != count; ++i)
+        {
+            // Mostly short delta times, with the occasional long one
+            unsigned bits = std::vector<unsigned>{ 7, 7, 7, 14, 14, 21, 28, 56, 63 }[generator() % 9];
+            result.push_back(generator() & ((uint64_t(1) << bits) - 1));
+        }
+
+        return result;
+    }
+
+    uint64_t decode_single(const std::vector<uint8_t>& bytes, io::VliStatus expected_status = io::VliStatus::ok)
+    {
+        const uint8_t* current = bytes.data();
+        uint64_t result = 0;
+        auto status = io::decode_variable_length_integer(current, bytes.data() + bytes.size(), &result);
+
+        CATCH_REQUIRE(status == expected_status);
+
+        return result;
+    }
+}
+
+
+TEST_CASE("Decoding variable length integer { 0x7F }")
+{
+    CATCH_CHECK(decode_single({ 0x7F }) == 0x7F);
+}
+
+TEST_CASE("Decoding variable length integer { 0x81, 0x00 }")
+{
+    CATCH_CHECK(decode_single({ 0x81, 0x00 }) == (1 << 7));
+}
+
+TEST_CASE("Decoding variable length integer { 0x81, 0x80, 0x80, 0x00 }")
+{
+    CATCH_CHECK(decode_single({ 0x81, 0x80, 0x80, 0x00 }) == (1 << 21));
+}
+
+TEST_CASE("Decoding variable length integer { 0b11111111, 0b10000000, 0b10000000, 0b10001100, 0b00000010 } with slack")
+{
+    CATCH_CHECK(decode_single({ 0b11111111, 0b10000000, 0b10000000, 0b10001100, 0b00000010, 0, 0, 0, 0 }) == 0b1111111'0000000'0000000'0001100'0000010);
+}
+
+TEST_CASE("Decoding variable length integer advances past the value only")
+{
+    std::vector<uint8_t> bytes = { 0x81, 0x80, 0x00, 0x05 };
+    const uint8_t* current = bytes.data();
+    uint64_t result;
+
+    CATCH_REQUIRE(io::decode_variable_length_integer(current, bytes.data() + bytes.size(), &result) == io::VliStatus::ok);
+    CATCH_CHECK(result == (1 << 14));
+    CATCH_CHECK(current == bytes.data() + 3);
+}
+
+TEST_CASE("Decoding largest 64-bit variable length integer")
+{
+    auto bytes = encode(0xFFFFFFFFFFFFFFFF);
+
+    CATCH_REQUIRE(bytes.size() == 10);
+    CATCH_CHECK(decode_single(bytes) == 0xFFFFFFFFFFFFFFFF);
+}
+
+TEST_CASE("Decoding truncated variable length integer")
+{
+    std::vector<uint8_t> bytes = { 0x81, 0x80 };
+    const uint8_t* current = bytes.data();
+    uint64_t result;
+
+    CATCH_CHECK(io::decode_variable_length_integer(current, bytes.data() + bytes.size(), &result) == io::VliStatus::truncated);
+    CATCH_CHECK(current == bytes.data());
+}
+
+TEST_CASE("Decoding empty buffer is truncated")
+{
+    std::vector<uint8_t> bytes;
+    const uint8_t* current = bytes.data();
+    uint64_t result;
+
+    CATCH_CHECK(io::decode_variable_length_integer(current, current, &result) == io::VliStatus::truncated);
+}
+
+TEST_CASE("Decoding variable length integer that does not fit in 64 bits")
+{
+    std::vector<uint8_t> bytes = { 0x82, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00 };
+
+    decode_single(bytes, io::VliStatus::overflow);
+}
+
+TEST_CASE("Decoding overlong run of continuation bytes")
+{
+    std::vector<uint8_t> bytes(20, 0x80);
+    bytes.push_back(0x01);
+
+    decode_single(bytes, io::VliStatus::overflow);
+}
+
+TEST_CASE("Batch decoding agrees with read_variable_length_integer")
+{
+    auto expected = random_delta_times(10000);
+    auto bytes = encode_all(expected);
+    std::vector<uint64_t> actual(expected.size());
+    const uint8_t* current = bytes.data();
+    io::VliStatus status;
+
+    auto decoded = io::decode_variable_length_integers(current, bytes.data() + bytes.size(), actual.data(), actual.size(), &status);
+
+    CATCH_REQUIRE(status == io::VliStatus::ok);
+    CATCH_REQUIRE(decoded == expected.size());
+    CATCH_CHECK(current == bytes.data() + bytes.size());
+
+    std::string data(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    std::stringstream ss(data);
+
+    for (size_t i = 0; i != expected.size(); ++i)
+    {
+        CATCH_REQUIRE(actual[i] == expected[i]);
+        CATCH_REQUIRE(io::read_variable_length_integer(ss) == expected[i]);
+    }
+}
+
+TEST_CASE("Batch decoding stops at truncated value")
+{
+    std::vector<uint8_t> bytes = { 0x01, 0x81, 0x00, 0x7F, 0x81 };
+    std::vector<uint64_t> results(4);
+    const uint8_t* current = bytes.data();
+    io::VliStatus status;
+
+    auto decoded = io::decode_variable_length_integers(current, bytes.data() + bytes.size(), results.data(), results.size(), &status);
+
+    CATCH_CHECK(status == io::VliStatus::truncated);
+    CATCH_REQUIRE(decoded == 3);
+    CATCH_CHECK(results[0] == 1);
+    CATCH_CHECK(results[1] == 128);
+    CATCH_CHECK(results[2] == 127);
+    CATCH_CHECK(current == bytes.data() + 4);
+}
+
+TEST_CASE("Benchmark variable length integer decoding", "[.benchmark]")
+{
+    auto values = random_delta_times(1000000);
+    auto bytes = encode_all(values);
+    std::string data(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    std::vector<uint64_t> results(values.size());
+    uint64_t checksum = 0;
+
+    BENCHMARK("read_variable_length_integer from std::istream")
+    {
+        std::stringstream ss(data);
+
+        for (size_t i = 0; i != values.size(); ++i)
+        {
+            checksum += io::read_variable_length_integer(ss);
+        }
+    }
+
+    BENCHMARK("read_variable_length_integer from io::ByteCursor")
+    {
+        io::ByteCursor in(bytes.data(), bytes.size());
+
+        for (size_t i = 0; i != values.size(); ++i)
+        {
+            checksum += io::read_variable_length_integer(in);
+        }
+    }
+
+    BENCHMARK("decode_variable_length_integers")
+    {
+        const uint8_t* current = bytes.data();
+        io::decode_variable_length_integers(current, bytes.data() + bytes.size(), results.data(), results.size(), nullptr);
+        checksum += results.back();
+    }
+
+    CATCH_CHECK(checksum != 0);
+}
+
+#endif
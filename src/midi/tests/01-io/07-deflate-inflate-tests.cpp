@@ -0,0 +1,73 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "io/deflate.h"
+#include "io/inflate.h"
+#include "Catch.h"
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    std::vector<uint8_t> deflate(const std::vector<uint8_t>& input, int level)
+    {
+        std::vector<uint8_t> result;
+        io::Deflater deflater(level, [&result](const uint8_t* data, size_t size) { result.insert(result.end(), data, data + size); });
+        deflater.write(input.data(), input.size());
+        deflater.finish();
+
+        return result;
+    }
+
+    std::vector<uint8_t> round_trip(const std::vector<uint8_t>& input, int level)
+    {
+        std::vector<uint8_t> compressed = deflate(input, level);
+
+        return io::inflate(compressed.data(), compressed.size());
+    }
+}
+
+TEST_CASE("Deflate and inflate, empty input")
+{
+    for (int level : { 0, 1, 9 })
+    {
+        CATCH_CHECK(round_trip(std::vector<uint8_t>(), level).empty());
+    }
+}
+
+TEST_CASE("Deflate and inflate, repetitive and random input at every level")
+{
+    std::mt19937 random(7);
+    std::vector<uint8_t> repetitive, noise;
+
+    for (unsigned i = 0; i != 150000; ++i)
+    {
+        repetitive.push_back(uint8_t((i / 5) % 17 * (i % 4000 < 2000)));
+        noise.push_back(uint8_t(random()));
+    }
+
+    for (int level = 0; level <= 9; ++level)
+    {
+        CATCH_CHECK(round_trip(repetitive, level) == repetitive);
+        CATCH_CHECK(round_trip(noise, level) == noise);
+    }
+
+    CATCH_CHECK(deflate(repetitive, 1).size() * 20 < repetitive.size());
+}
+
+TEST_CASE("Inflate, dynamic Huffman block")
+{
+    // zlib.compress(b"aadadcacaaabbacbabddbabaa", 9), which zlib encodes with a dynamic Huffman block
+    const uint8_t compressed[] = {
+        0x78, 0xda, 0x0d, 0xc4, 0x31, 0x01, 0x00, 0x00, 0x0c, 0x02, 0xa0, 0xac, 0xa8, 0xfd, 0x33, 0x6c,
+        0x1c, 0x30, 0xab, 0x22, 0xd1, 0xc8, 0xf6, 0x71, 0x7c, 0x80, 0x09, 0x92
+    };
+    std::vector<uint8_t> result = io::inflate(compressed, sizeof(compressed));
+
+    CATCH_CHECK(std::string(result.begin(), result.end()) == "aadadcacaaabbacbabddbabaa");
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "io/async-file-writer.h"
+#include "Catch.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    std::string path(unsigned i)
+    {
+        return "async-file-writer-test-" + std::to_string(i) + ".bin";
+    }
+
+    std::string contents(unsigned i)
+    {
+        return std::string(1000 + i * 37, char('a' + i % 26));
+    }
+
+    std::string read_file(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream result;
+        result << in.rdbuf();
+
+        return result.str();
+    }
+}
+
+TEST_CASE("AsyncFileWriter, writes every file")
+{
+    const unsigned count = 40;
+
+    for (size_t depth : { 1u, 3u, 100u })
+    {
+        io::AsyncFileWriter writer(depth);
+
+        for (unsigned i = 0; i != count; ++i)
+        {
+            writer.write(path(i), contents(i));
+        }
+
+        CATCH_CHECK(writer.finish());
+
+        for (unsigned i = 0; i != count; ++i)
+        {
+            CATCH_CHECK(read_file(path(i)) == contents(i));
+            std::remove(path(i).c_str());
+        }
+    }
+}
+
+TEST_CASE("AsyncFileWriter, concurrent producers")
+{
+    const unsigned count = 60;
+    io::AsyncFileWriter writer(2);
+    std::vector<std::thread> producers;
+
+    for (unsigned p = 0; p != 3; ++p)
+    {
+        producers.emplace_back([&writer, p]() {
+            for (unsigned i = p; i < count; i += 3)
+            {
+                writer.write(path(i), contents(i));
+            }
+        });
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    CATCH_CHECK(writer.finish());
+
+    for (unsigned i = 0; i != count; ++i)
+    {
+        CATCH_CHECK(read_file(path(i)) == contents(i));
+        std::remove(path(i).c_str());
+    }
+}
+
+TEST_CASE("AsyncFileWriter, reports failed writes")
+{
+    io::AsyncFileWriter writer(1);
+    writer.write("no-such-directory/async-file-writer-test.bin", "data");
+
+    CATCH_CHECK(!writer.finish());
+}
+
+TEST_CASE("AsyncFileWriter, write blocks while the queue is full")
+{
+    const size_t depth = 2;
+    std::atomic<bool> busy(false);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+
+    // Holds the I/O thread in the first file until released
+    io::AsyncFileWriter writer(depth, [&busy, released](const std::string&, const std::string&) {
+        busy = true;
+        released.wait();
+        return true;
+    });
+
+    std::atomic<unsigned> completed(0);
+    std::thread producer([&writer, &completed]() {
+        for (unsigned i = 0; i != depth + 2; ++i)
+        {
+            writer.write(path(i), contents(i));
+            ++completed;
+        }
+    });
+
+    // One file is being written and depth more are queued; the next write has to wait
+    while (!busy || completed < depth + 1)
+    {
+        std::this_thread::yield();
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CATCH_CHECK(completed == depth + 1);
+
+    release.set_value();
+    producer.join();
+
+    CATCH_CHECK(completed == depth + 2);
+    CATCH_CHECK(writer.finish());
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "tests/tests-util.h"
+#include "midi/mtrk-reader.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace testutils;
+
+namespace
+{
+    // Not an EventReceiver: only usable through the read_mtrk template
+    struct EventLog
+    {
+        std::string log;
+
+        void note_on(midi::Duration dt, midi::Channel channel, midi::NoteNumber note, uint8_t velocity) { append("on", dt, value(note)); }
+        void note_off(midi::Duration dt, midi::Channel channel, midi::NoteNumber note, uint8_t velocity) { append("off", dt, value(note)); }
+        void polyphonic_key_pressure(midi::Duration dt, midi::Channel channel, midi::NoteNumber note, uint8_t pressure) { append("poly", dt, pressure); }
+        void control_change(midi::Duration dt, midi::Channel channel, uint8_t controller, uint8_t value) { append("cc", dt, controller); }
+        void program_change(midi::Duration dt, midi::Channel channel, midi::Instrument program) { append("program", dt, value(program)); }
+        void channel_pressure(midi::Duration dt, midi::Channel channel, uint8_t pressure) { append("pressure", dt, pressure); }
+        void pitch_wheel_change(midi::Duration dt, midi::Channel channel, uint16_t value) { append("pitch", dt, value); }
+        void meta(midi::Duration dt, uint8_t type, std::unique_ptr<uint8_t[]> data, uint64_t data_size) { append("meta", dt, type); }
+        void sysex(midi::Duration dt, std::unique_ptr<uint8_t[]> data, uint64_t data_size) { append("sysex", dt, unsigned(data_size)); }
+
+        void append(const char* kind, midi::Duration dt, unsigned argument)
+        {
+            log += std::string(kind) + "@" + std::to_string(value(dt)) + ":" + std::to_string(argument) + " ";
+        }
+    };
+}
+
+TEST_CASE("Reading MTrk with a statically dispatched receiver")
+{
+    char buffer[] = {
+        MTRK,
+        0x00, 0x00, 0x00, 22, // Length
+        0, PROGRAM_CHANGE(0, 7),
+        5, NOTE_ON(0, 60, 100),
+        10, NOTE_ON_RS(64, 0),
+        0, CONTROL_CHANGE(1, 7, 127),
+        3, NOTE_OFF(0, 60, 0),
+        END_OF_TRACK
+    };
+    const std::string expected = "program@0:7 on@5:60 on@10:64 cc@0:7 off@3:60 meta@0:47 ";
+
+    std::stringstream ss(std::string(buffer, sizeof(buffer)));
+    EventLog from_stream;
+    midi::read_mtrk(ss, from_stream);
+
+    io::ByteCursor cursor(reinterpret_cast<const uint8_t*>(buffer), sizeof(buffer));
+    EventLog from_buffer;
+    midi::read_mtrk(cursor, from_buffer);
+
+    CATCH_CHECK(from_stream.log == expected);
+    CATCH_CHECK(from_buffer.log == expected);
+    CATCH_CHECK(cursor.at_end());
+}
+
+TEST_CASE("Reading MTrk from buffer passes meta and sysex payloads in place")
+{
+    struct PayloadReceiver
+    {
+        std::vector<io::ByteSpan> payloads;
+
+        void note_on(midi::Duration, midi::Channel, midi::NoteNumber, uint8_t) { }
+        void note_off(midi::Duration, midi::Channel, midi::NoteNumber, uint8_t) { }
+        void polyphonic_key_pressure(midi::Duration, midi::Channel, midi::NoteNumber, uint8_t) { }
+        void control_change(midi::Duration, midi::Channel, uint8_t, uint8_t) { }
+        void program_change(midi::Duration, midi::Channel, midi::Instrument) { }
+        void channel_pressure(midi::Duration, midi::Channel, uint8_t) { }
+        void pitch_wheel_change(midi::Duration, midi::Channel, uint16_t) { }
+        void meta(midi::Duration, uint8_t, io::ByteSpan data) { payloads.push_back(data); }
+        void sysex(midi::Duration, io::ByteSpan data) { payloads.push_back(data); }
+    };
+
+    char buffer[] = {
+        MTRK,
+        0x00, 0x00, 0x00, 16, // Length
+        0, char(0xFF), 0x01, 3, 'a', 'b', 'c',
+        0, char(0xF0), 2, 'x', 'y',
+        END_OF_TRACK
+    };
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(buffer);
+
+    io::ByteCursor cursor(bytes, sizeof(buffer));
+    PayloadReceiver receiver;
+    midi::read_mtrk(cursor, receiver);
+
+    CATCH_REQUIRE(receiver.payloads.size() == 3);
+    CATCH_CHECK(receiver.payloads[0].data == bytes + 12);
+    CATCH_CHECK(receiver.payloads[0].size == 3);
+    CATCH_CHECK(receiver.payloads[1].data == bytes + 18);
+    CATCH_CHECK(receiver.payloads[1].size == 2);
+    CATCH_CHECK(receiver.payloads[2].size == 0);
+}
+
+#endif
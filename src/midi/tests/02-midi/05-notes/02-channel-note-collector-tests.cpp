@@ -250,6 +250,21 @@ TEST_CASE("Two consecutive note on (with velocity != 0) events")
     CATCH_CHECK(notes[1] == midi::NOTE(midi::NoteNumber(5), midi::Time(100), midi::Duration(200), 127, midi::Instrument(0)));
 }
 
+TEST_CASE("Notes after a repeated note on keep their timing")
+{
+    std::vector<midi::NOTE> notes;
+    midi::ChannelNoteCollector collector(midi::Channel(0), [&notes](const midi::NOTE& note) { notes.push_back(note); });
+
+    collector.note_on(midi::Duration(0), midi::Channel(0), midi::NoteNumber(5), 127);
+    collector.note_on(midi::Duration(100), midi::Channel(0), midi::NoteNumber(5), 127);
+    collector.note_off(midi::Duration(200), midi::Channel(0), midi::NoteNumber(5), 0);
+    collector.note_on(midi::Duration(50), midi::Channel(0), midi::NoteNumber(6), 127);
+    collector.note_off(midi::Duration(10), midi::Channel(0), midi::NoteNumber(6), 0);
+
+    CATCH_REQUIRE(notes.size() == 3);
+    CATCH_CHECK(notes[2] == midi::NOTE(midi::NoteNumber(6), midi::Time(350), midi::Duration(10), 127, midi::Instrument(0)));
+}
+
 TEST_CASE("Stress test #1: many notes should be done in reasonable time")
 {
     unsigned collector_counter = 0;
@@ -160,6 +160,42 @@ TEST_CASE("Multicaster test, one receiver, one event (meta)")
     }
 }
 
+TEST_CASE("Multicaster test, three receivers, one event (meta)")
+{
+    std::string data = "fjlsaq";
+    auto create_receiver = [&data]() {
+        return std::shared_ptr<TestEventReceiver>(Builder().meta(midi::Duration(1), 9, data).build().release());
+    };
+
+    std::vector<std::shared_ptr<TestEventReceiver>> receivers{ create_receiver(), create_receiver(), create_receiver() };
+    midi::EventMulticaster multicaster(std::vector<std::shared_ptr<midi::EventReceiver>>(receivers.begin(), receivers.end()));
+
+    multicaster.meta(midi::Duration(1), 9, copy_string_to_char_array(data), data.size());
+
+    for (auto receiver : receivers)
+    {
+        receiver->check_finished();
+    }
+}
+
+TEST_CASE("Multicaster test, three receivers, one event (sysex)")
+{
+    std::string data = "abc";
+    auto create_receiver = [&data]() {
+        return std::shared_ptr<TestEventReceiver>(Builder().sysex(midi::Duration(4), data).build().release());
+    };
+
+    std::vector<std::shared_ptr<TestEventReceiver>> receivers{ create_receiver(), create_receiver(), create_receiver() };
+    midi::EventMulticaster multicaster(std::vector<std::shared_ptr<midi::EventReceiver>>(receivers.begin(), receivers.end()));
+
+    multicaster.sysex(midi::Duration(4), copy_string_to_char_array(data), data.size());
+
+    for (auto receiver : receivers)
+    {
+        receiver->check_finished();
+    }
+}
+
 TEST_CASE("Multicaster test, one receiver, two events")
 {
     auto create_receiver = []() {
@@ -4,6 +4,8 @@
 
 #include "midi/midi.h"
 #include "Catch.h"
+#include <memory>
+#include <random>
 #include <vector>
 
 
@@ -152,4 +154,54 @@ TEST_CASE("NoteCollector with two consecutive notes, instrument change on differ
     CATCH_CHECK(notes[1] == midi::NOTE(midi::NoteNumber(7), midi::Time(200), midi::Duration(100), 113, midi::Instrument(41)));
 }
 
+TEST_CASE("NoteCollector produces the same notes as one ChannelNoteCollector per channel")
+{
+    std::vector<midi::NOTE> expected;
+    std::vector<midi::NOTE> actual;
+    std::vector<std::shared_ptr<midi::EventReceiver>> channel_collectors;
+
+    for (unsigned channel = 0; channel != 16; ++channel)
+    {
+        channel_collectors.push_back(std::make_shared<midi::ChannelNoteCollector>(midi::Channel(channel), [&expected](const midi::NOTE& note) { expected.push_back(note); }));
+    }
+
+    midi::EventMulticaster multicaster(channel_collectors);
+    midi::NoteCollector collector([&actual](const midi::NOTE& note) { actual.push_back(note); });
+    std::mt19937 random(42);
+
+    for (unsigned i = 0; i != 10000; ++i)
+    {
+        midi::Duration dt(random() % 50);
+        midi::Channel channel(random() % 16);
+        midi::NoteNumber note(random() % 8);
+        uint8_t velocity = uint8_t(random() % 4 == 0 ? 0 : 1 + random() % 127);
+
+        switch (random() % 4)
+        {
+        case 0:
+            multicaster.note_on(dt, channel, note, velocity);
+            collector.note_on(dt, channel, note, velocity);
+            break;
+
+        case 1:
+            multicaster.note_off(dt, channel, note, velocity);
+            collector.note_off(dt, channel, note, velocity);
+            break;
+
+        case 2:
+            multicaster.program_change(dt, channel, midi::Instrument(velocity));
+            collector.program_change(dt, channel, midi::Instrument(velocity));
+            break;
+
+        default:
+            multicaster.control_change(dt, channel, 7, velocity);
+            collector.control_change(dt, channel, 7, velocity);
+            break;
+        }
+    }
+
+    CATCH_REQUIRE(actual.size() == expected.size());
+    CATCH_CHECK(actual == expected);
+}
+
 #endif
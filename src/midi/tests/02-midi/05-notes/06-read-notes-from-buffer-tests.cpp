@@ -0,0 +1,199 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "midi/midi.h"
+#include "tests/tests-util.h"
+#include "Catch.h"
+#include <vector>
+#include <sstream>
+
+using namespace testutils;
+
+
+namespace
+{
+    std::vector<midi::NOTE> read_notes_both_ways(const char* buffer, size_t size)
+    {
+        std::string data(buffer, size);
+        std::stringstream ss(data);
+        std::vector<midi::NOTE> expected = midi::read_notes(ss);
+        std::vector<midi::NOTE> actual = midi::read_notes(reinterpret_cast<const uint8_t*>(buffer), size);
+
+        CATCH_REQUIRE(actual.size() == expected.size());
+
+        for (size_t i = 0; i != expected.size(); ++i)
+        {
+            CATCH_CHECK(actual[i] == expected[i]);
+        }
+
+        return actual;
+    }
+}
+
+
+TEST_CASE("read_notes from buffer, zero tracks")
+{
+    char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x00, // Number of tracks
+        0x01, 0x00, // Division
+    };
+    auto notes = read_notes_both_ways(buffer, sizeof(buffer));
+
+    CATCH_CHECK(notes.size() == 0);
+}
+
+TEST_CASE("read_notes from buffer, single note with instrument 5")
+{
+    char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x01, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 15, // MTrk size
+        0, PROGRAM_CHANGE(0, 5),
+        0, NOTE_ON(0, 5, 127),
+        100, NOTE_OFF(0, 5, 0),
+        END_OF_TRACK
+    };
+    auto notes = read_notes_both_ways(buffer, sizeof(buffer));
+
+    CATCH_REQUIRE(notes.size() == 1);
+    CATCH_CHECK(notes[0] == midi::NOTE(midi::NoteNumber(5), midi::Time(0), midi::Duration(100), 127, midi::Instrument(5)));
+}
+
+TEST_CASE("read_notes from buffer, two notes on different tracks")
+{
+    char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x02, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 12, // MTrk size
+        0, NOTE_ON(0, 5, 100),
+        100, NOTE_OFF(0, 5, 0),
+        END_OF_TRACK,
+        MTRK,
+        0x00, 0x00, 0x00, 12, // MTrk size
+        0, NOTE_ON(0, 88, 90),
+        100, NOTE_OFF(0, 88, 0),
+        END_OF_TRACK
+    };
+    auto notes = read_notes_both_ways(buffer, sizeof(buffer));
+
+    CATCH_REQUIRE(notes.size() == 2);
+    CATCH_CHECK(notes[0] == midi::NOTE(midi::NoteNumber(5), midi::Time(0), midi::Duration(100), 100, midi::Instrument(0)));
+    CATCH_CHECK(notes[1] == midi::NOTE(midi::NoteNumber(88), midi::Time(0), midi::Duration(100), 90, midi::Instrument(0)));
+}
+
+TEST_CASE("read_notes from buffer, running status and note on with 0 velocity")
+{
+    char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x01, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 17, // MTrk size
+        0, NOTE_ON(0, 5, 123),
+        0, NOTE_ON_RS(6, 111),
+        100, NOTE_ON_RS(5, 0), // Note "off"
+        0, NOTE_ON_RS(6, 0), // Note "off"
+        END_OF_TRACK
+    };
+    auto notes = read_notes_both_ways(buffer, sizeof(buffer));
+
+    CATCH_REQUIRE(notes.size() == 2);
+    CATCH_CHECK(notes[0] == midi::NOTE(midi::NoteNumber(5), midi::Time(0), midi::Duration(100), 123, midi::Instrument(0)));
+    CATCH_CHECK(notes[1] == midi::NOTE(midi::NoteNumber(6), midi::Time(0), midi::Duration(100), 111, midi::Instrument(0)));
+}
+
+TEST_CASE("read_notes from buffer, notes between meta and sysex events")
+{
+    char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x01, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 29, // MTrk size
+        0, char(0xFF), 0x51, 0x03, 0x07, char(0xA1), 0x20, // Set tempo
+        0, NOTE_ON(1, 60, 64),
+        char(0x81), 0x00, char(0xF0), 0x02, 0x7E, char(0xF7), // Sysex at dt = 128
+        10, PITCH_WHEEL_CHANGE(1, 0x2000),
+        5, NOTE_OFF(1, 60, 0),
+        END_OF_TRACK
+    };
+    auto notes = read_notes_both_ways(buffer, sizeof(buffer));
+
+    CATCH_REQUIRE(notes.size() == 1);
+    CATCH_CHECK(notes[0] == midi::NOTE(midi::NoteNumber(60), midi::Time(0), midi::Duration(143), 64, midi::Instrument(0)));
+}
+
+TEST_CASE("read_notes from buffer, 1000 notes")
+{
+    const unsigned N_NOTES = 1000;
+    std::vector<char> buffer = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x01, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, char(0x5D), char(0xC4), // MTrk size (12 * N_NOTES + 4)
+    };
+
+    for (unsigned i = 0; i != N_NOTES; ++i)
+    {
+        const char bytes[] = {
+            0, NOTE_ON(0, 69, 71),
+            100, NOTE_OFF(0, 69, 71)
+        };
+
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(bytes));
+    }
+
+    const char end_of_track[] = { END_OF_TRACK };
+    buffer.insert(buffer.end(), end_of_track, end_of_track + sizeof(end_of_track));
+
+    auto notes = read_notes_both_ways(buffer.data(), buffer.size());
+
+    CATCH_REQUIRE(notes.size() == N_NOTES);
+}
+
+TEST_CASE("Reading MTrk from buffer delivers the same events as from stream")
+{
+    char buffer[] = {
+        MTRK,
+        0x00, 0x00, 0x00, 20, // Length
+        0, char(0xF0), 0x03, 'a', 'b', 'c', // Sysex
+        5, NOTE_ON(3, 40, 20),
+        7, NOTE_ON_RS(41, 21),
+        1, CONTROL_CHANGE(3, 7, 100),
+        END_OF_TRACK
+    };
+    io::ByteCursor in(reinterpret_cast<const uint8_t*>(buffer), sizeof(buffer));
+
+    auto receiver = Builder()
+        .sysex(midi::Duration(0), "abc")
+        .note_on(midi::Duration(5), midi::Channel(3), midi::NoteNumber(40), 20)
+        .note_on(midi::Duration(7), midi::Channel(3), midi::NoteNumber(41), 21)
+        .control_change(midi::Duration(1), midi::Channel(3), 7, 100)
+        .meta(midi::Duration(0), 0x2F, "")
+        .build();
+
+    read_mtrk(in, *receiver);
+    receiver->check_finished();
+    CATCH_CHECK(in.at_end());
+}
+
+#endif
@@ -0,0 +1,123 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "midi/midi.h"
+#include "Catch.h"
+#include <vector>
+
+namespace
+{
+    // tests-util.h defines MTHD as a macro
+    using MidiHeader = midi::MTHD;
+}
+
+#include "tests/tests-util.h"
+
+
+namespace
+{
+    std::vector<char> build_multitrack_file(unsigned ntracks, unsigned notes_per_track)
+    {
+        std::vector<char> buffer = {
+            MTHD,
+            0x00, 0x00, 0x00, 0x06, // MThd size
+            0x00, 0x01, // Type
+            char(ntracks >> 8), char(ntracks), // Number of tracks
+            0x01, 0x00, // Division
+        };
+
+        for (unsigned track = 0; track != ntracks; ++track)
+        {
+            std::vector<char> mtrk;
+
+            for (unsigned i = 0; i != notes_per_track; ++i)
+            {
+                const char bytes[] = {
+                    char(track % 8), NOTE_ON(track % 16, (track + i) % 128, 1 + i % 127),
+                    char(10 + track), NOTE_OFF(track % 16, (track + i) % 128, 0)
+                };
+
+                mtrk.insert(mtrk.end(), bytes, bytes + sizeof(bytes));
+            }
+
+            const char end_of_track[] = { END_OF_TRACK };
+            mtrk.insert(mtrk.end(), end_of_track, end_of_track + sizeof(end_of_track));
+
+            uint32_t size = uint32_t(mtrk.size());
+            const char header[] = { MTRK, char(size >> 24), char(size >> 16), char(size >> 8), char(size) };
+            buffer.insert(buffer.end(), header, header + sizeof(header));
+            buffer.insert(buffer.end(), mtrk.begin(), mtrk.end());
+        }
+
+        return buffer;
+    }
+
+    const uint8_t* bytes(const std::vector<char>& buffer)
+    {
+        return reinterpret_cast<const uint8_t*>(buffer.data());
+    }
+}
+
+
+TEST_CASE("find_mtrk_chunks, zero tracks")
+{
+    auto buffer = build_multitrack_file(0, 0);
+    MidiHeader mthd;
+    auto tracks = midi::find_mtrk_chunks(bytes(buffer), buffer.size(), &mthd);
+
+    CATCH_CHECK(mthd.ntracks == 0);
+    CATCH_CHECK(tracks.size() == 0);
+}
+
+TEST_CASE("find_mtrk_chunks, skips unknown chunks")
+{
+    char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x02, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 4, // MTrk size
+        END_OF_TRACK,
+        'X', 'Y', 'Z', 'W',
+        0x00, 0x00, 0x00, 3, // Unknown chunk size
+        1, 2, 3,
+        MTRK,
+        0x00, 0x00, 0x00, 4, // MTrk size
+        END_OF_TRACK
+    };
+    MidiHeader mthd;
+    auto tracks = midi::find_mtrk_chunks(reinterpret_cast<const uint8_t*>(buffer), sizeof(buffer), &mthd);
+
+    CATCH_REQUIRE(tracks.size() == 2);
+    CATCH_CHECK(tracks[0].current == reinterpret_cast<const uint8_t*>(buffer) + 14);
+    CATCH_CHECK(tracks[1].current == reinterpret_cast<const uint8_t*>(buffer) + 37);
+}
+
+TEST_CASE("read_notes_parallel, single track")
+{
+    auto buffer = build_multitrack_file(1, 10);
+    auto expected = midi::read_notes(bytes(buffer), buffer.size());
+    auto actual = midi::read_notes_parallel(bytes(buffer), buffer.size(), 4);
+
+    CATCH_REQUIRE(actual.size() == 10);
+    CATCH_CHECK(actual == expected);
+}
+
+TEST_CASE("read_notes_parallel, 40 tracks, merged in track order")
+{
+    auto buffer = build_multitrack_file(40, 200);
+    auto expected = midi::read_notes(bytes(buffer), buffer.size());
+
+    for (unsigned workers : { 0u, 1u, 3u, 8u, 64u })
+    {
+        auto actual = midi::read_notes_parallel(bytes(buffer), buffer.size(), workers);
+
+        CATCH_REQUIRE(actual.size() == 40 * 200);
+        CATCH_CHECK(actual == expected);
+    }
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "midi/note-table.h"
+#include "tests/tests-util.h"
+#include "Catch.h"
+#include <vector>
+#include <sstream>
+
+
+TEST_CASE("NoteTable, empty")
+{
+    midi::NoteTable table;
+
+    CATCH_CHECK(table.size() == 0);
+    CATCH_CHECK(table.empty());
+    CATCH_CHECK(table.is_compact());
+    CATCH_CHECK(table.end() == midi::Time(0));
+    CATCH_CHECK(table.lowest_note() == midi::NoteNumber(127));
+    CATCH_CHECK(table.highest_note() == midi::NoteNumber(0));
+}
+
+TEST_CASE("NoteTable, round trip")
+{
+    std::vector<midi::NOTE> notes = {
+        midi::NOTE(midi::NoteNumber(60), midi::Time(0), midi::Duration(100), 64, midi::Instrument(1)),
+        midi::NOTE(midi::NoteNumber(20), midi::Time(50), midi::Duration(500), 127, midi::Instrument(2)),
+        midi::NOTE(midi::NoteNumber(99), midi::Time(300), midi::Duration(10), 1, midi::Instrument(3)),
+    };
+    midi::NoteTable table(notes);
+
+    CATCH_REQUIRE(table.size() == 3);
+    CATCH_CHECK(table.is_compact());
+    CATCH_CHECK(table[1] == notes[1]);
+    CATCH_CHECK(table.to_notes() == notes);
+    CATCH_CHECK(table.end() == midi::Time(550));
+    CATCH_CHECK(table.lowest_note() == midi::NoteNumber(20));
+    CATCH_CHECK(table.highest_note() == midi::NoteNumber(99));
+}
+
+TEST_CASE("NoteTable, widens time columns when needed")
+{
+    midi::NoteTable table;
+    table.push_back(midi::NOTE(midi::NoteNumber(1), midi::Time(10), midi::Duration(5), 1, midi::Instrument(0)));
+    table.push_back(midi::NOTE(midi::NoteNumber(2), midi::Time(0xFFFFFFF0), midi::Duration(0x20), 1, midi::Instrument(0)));
+    table.push_back(midi::NOTE(midi::NoteNumber(3), midi::Time(20), midi::Duration(5), 1, midi::Instrument(0)));
+
+    CATCH_CHECK(!table.is_compact());
+    CATCH_CHECK(table.start(0) == midi::Time(10));
+    CATCH_CHECK(table.duration(0) == midi::Duration(5));
+    CATCH_CHECK(table.start(1) == midi::Time(0xFFFFFFF0));
+    CATCH_CHECK(table.start(2) == midi::Time(20));
+    CATCH_CHECK(table.end() == midi::Time(0x100000010));
+}
+
+TEST_CASE("read_notes_columnar agrees with read_notes")
+{
+    char buffer[] = {
+        MTHD,
+        0x00, 0x00, 0x00, 0x06, // MThd size
+        0x00, 0x01, // Type
+        0x00, 0x02, // Number of tracks
+        0x01, 0x00, // Division
+        MTRK,
+        0x00, 0x00, 0x00, 23, // MTrk size
+        0, PROGRAM_CHANGE(0, 1),
+        0, NOTE_ON(0, 5, 120),
+        100, NOTE_OFF(0, 5, 0),
+        0, PROGRAM_CHANGE(0, 2),
+        100, NOTE_ON(0, 8, 100),
+        100, NOTE_ON(0, 8, 0),
+        END_OF_TRACK,
+        MTRK,
+        0x00, 0x00, 0x00, 12, // MTrk size
+        0, NOTE_ON(0, 88, 90),
+        100, NOTE_OFF(0, 88, 0),
+        END_OF_TRACK
+    };
+    std::string data(buffer, sizeof(buffer));
+    std::stringstream ss1(data);
+    std::stringstream ss2(data);
+    auto expected = midi::read_notes(ss1);
+    auto from_stream = midi::read_notes_columnar(ss2);
+    auto from_buffer = midi::read_notes_columnar(reinterpret_cast<const uint8_t*>(buffer), sizeof(buffer));
+
+    CATCH_REQUIRE(expected.size() == 3);
+    CATCH_CHECK(from_stream.to_notes() == expected);
+    CATCH_CHECK(from_buffer.to_notes() == expected);
+    CATCH_CHECK(from_buffer.is_compact());
+}
+
+#endif
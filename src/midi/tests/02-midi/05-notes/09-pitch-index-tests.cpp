@@ -0,0 +1,110 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "tests/tests-util.h"
+#include "midi/pitch-index.h"
+#include <vector>
+
+
+using testutils::note;
+
+TEST_CASE("PitchIndex, empty table")
+{
+    midi::NoteTable table;
+    midi::PitchIndex index(table);
+
+    for (int i = 0; i != 128; ++i)
+    {
+        CATCH_CHECK(index.notes(midi::NoteNumber(i)).empty());
+        CATCH_CHECK(index.overlapping(midi::NoteNumber(i), midi::Time(0), midi::Time(1000)).empty());
+    }
+}
+
+TEST_CASE("PitchIndex, groups by note number sorted by start")
+{
+    midi::NoteTable table(std::vector<midi::NOTE> {
+        note(60, 300, 10),
+        note(20, 0, 5),
+        note(60, 100, 10),
+        note(60, 200, 10),
+        note(20, 50, 5),
+    });
+    midi::PitchIndex index(table);
+
+    CATCH_CHECK(index.notes(midi::NoteNumber(60)) == std::vector<size_t>({ 2, 3, 0 }));
+    CATCH_CHECK(index.notes(midi::NoteNumber(20)) == std::vector<size_t>({ 1, 4 }));
+    CATCH_CHECK(index.notes(midi::NoteNumber(21)).empty());
+}
+
+TEST_CASE("PitchIndex, overlapping")
+{
+    midi::NoteTable table(std::vector<midi::NOTE> {
+        note(60, 0, 1000),
+        note(60, 100, 10),
+        note(60, 200, 10),
+        note(60, 300, 10),
+        note(61, 150, 10),
+    });
+    midi::PitchIndex index(table);
+    auto query = [&index](uint64_t from, uint64_t to) {
+        return index.overlapping(midi::NoteNumber(60), midi::Time(from), midi::Time(to));
+    };
+
+    CATCH_CHECK(query(150, 250) == std::vector<size_t>({ 0, 2 }));
+    CATCH_CHECK(query(105, 106) == std::vector<size_t>({ 0, 1 }));
+    CATCH_CHECK(query(110, 200) == std::vector<size_t>({ 0 }));
+    CATCH_CHECK(query(1000, 2000).empty());
+    CATCH_CHECK(query(0, 1) == std::vector<size_t>({ 0 }));
+}
+
+TEST_CASE("PitchIndex, overlapping with a pedal tone")
+{
+    std::vector<midi::NOTE> notes{ note(60, 0, 1000000) };
+
+    for (unsigned i = 0; i != 1000; ++i)
+    {
+        notes.push_back(note(60, 10 + 100 * i, 50));
+    }
+
+    midi::NoteTable table(notes);
+    midi::PitchIndex index(table);
+
+    CATCH_CHECK(index.overlapping(midi::NoteNumber(60), midi::Time(50005), midi::Time(50015)) == std::vector<size_t>({ 0, 501 }));
+    CATCH_CHECK(index.overlapping(midi::NoteNumber(60), midi::Time(50070), midi::Time(50100)) == std::vector<size_t>({ 0 }));
+}
+
+TEST_CASE("PitchIndex, overlapping agrees with a linear scan")
+{
+    std::vector<midi::NOTE> notes;
+
+    for (unsigned i = 0; i != 500; ++i)
+    {
+        notes.push_back(note((i * 7) % 5, (i * 37) % 1000, 1 + (i * 13) % 50));
+    }
+
+    midi::NoteTable table(notes);
+    midi::PitchIndex index(table);
+
+    for (uint64_t from = 0; from < 1100; from += 45)
+    {
+        for (int n = 0; n != 5; ++n)
+        {
+            std::vector<size_t> expected;
+
+            for (size_t row : index.notes(midi::NoteNumber(n)))
+            {
+                uint64_t start = value(table.start(row));
+
+                if (start < from + 30 && start + value(table.duration(row)) > from)
+                {
+                    expected.push_back(row);
+                }
+            }
+
+            CATCH_CHECK(index.overlapping(midi::NoteNumber(n), midi::Time(from), midi::Time(from + 30)) == expected);
+        }
+    }
+}
+
+#endif
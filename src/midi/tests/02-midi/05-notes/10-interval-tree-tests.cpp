@@ -0,0 +1,101 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "tests/tests-util.h"
+#include "midi/interval-tree.h"
+#include <vector>
+
+
+using testutils::note;
+
+TEST_CASE("IntervalTree, empty")
+{
+    midi::IntervalTree tree;
+
+    CATCH_CHECK(tree.empty());
+    CATCH_CHECK(tree.overlapping(midi::Time(0), midi::Time(1000)).empty());
+}
+
+TEST_CASE("IntervalTree, sorts by start")
+{
+    midi::IntervalTree tree(std::vector<midi::NOTE> {
+        note(1, 300, 10),
+        note(2, 0, 5),
+        note(3, 100, 10),
+    });
+
+    CATCH_CHECK(tree.notes() == std::vector<midi::NOTE>({ note(2, 0, 5), note(3, 100, 10), note(1, 300, 10) }));
+}
+
+TEST_CASE("IntervalTree, overlapping")
+{
+    midi::IntervalTree tree(std::vector<midi::NOTE> {
+        note(1, 0, 1000),
+        note(2, 100, 10),
+        note(3, 200, 10),
+        note(4, 300, 10),
+        note(5, 150, 10),
+    });
+    auto query = [&tree](uint64_t from, uint64_t to) {
+        return tree.overlapping(midi::Time(from), midi::Time(to));
+    };
+
+    CATCH_CHECK(query(150, 250) == std::vector<midi::NOTE>({ note(1, 0, 1000), note(5, 150, 10), note(3, 200, 10) }));
+    CATCH_CHECK(query(110, 150) == std::vector<midi::NOTE>({ note(1, 0, 1000) }));
+    CATCH_CHECK(query(109, 110) == std::vector<midi::NOTE>({ note(1, 0, 1000), note(2, 100, 10) }));
+    CATCH_CHECK(query(1000, 2000).empty());
+    CATCH_CHECK(query(500, 500).empty());
+}
+
+TEST_CASE("IntervalTree, from NoteTable")
+{
+    midi::NoteTable table(std::vector<midi::NOTE> { note(1, 50, 10), note(2, 0, 100) });
+    midi::IntervalTree tree(table);
+
+    CATCH_CHECK(tree.overlapping(midi::Time(55), midi::Time(56)) == std::vector<midi::NOTE>({ note(2, 0, 100), note(1, 50, 10) }));
+}
+
+TEST_CASE("IntervalTree, copy of a tree built from notes")
+{
+    midi::IntervalTree copy;
+
+    {
+        midi::IntervalTree tree(std::vector<midi::NOTE> { note(1, 50, 10), note(2, 0, 100) });
+        copy = tree;
+    }
+
+    CATCH_CHECK(copy.overlapping(midi::Time(55), midi::Time(56)) == std::vector<midi::NOTE>({ note(2, 0, 100), note(1, 50, 10) }));
+}
+
+TEST_CASE("IntervalTree, overlapping agrees with a linear scan")
+{
+    std::vector<midi::NOTE> notes;
+
+    for (unsigned i = 0; i != 1000; ++i)
+    {
+        notes.push_back(note(i % 128, (i * 37) % 2000, (i * 13) % 300));
+    }
+
+    midi::IntervalTree tree(notes);
+
+    for (uint64_t from = 0; from < 2400; from += 35)
+    {
+        uint64_t to = from + 50;
+        std::vector<midi::NOTE> expected;
+
+        for (const auto& n : tree.notes())
+        {
+            uint64_t start = value(n.start);
+
+            if (start < to && start + value(n.duration) > from)
+            {
+                expected.push_back(n);
+            }
+        }
+
+        CATCH_CHECK(tree.overlapping(midi::Time(from), midi::Time(to)) == expected);
+    }
+}
+
+#endif
@@ -0,0 +1,137 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "midi/tempo-map.h"
+#include "Catch.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // tests-util.h defines MTHD as a macro
+    using MidiHeader = midi::MTHD;
+}
+
+#include "tests/tests-util.h"
+
+#define SET_TEMPO(tempo)                        char(0xFF), 0x51, 0x03, char((tempo) >> 16), char((tempo) >> 8), char(tempo)
+
+
+namespace
+{
+    midi::TempoChange change(uint64_t time, uint32_t tempo)
+    {
+        return midi::TempoChange{ midi::Time(time), tempo };
+    }
+
+    uint64_t us(const midi::TempoMap& map, uint64_t ticks)
+    {
+        return map.microseconds(midi::Time(ticks));
+    }
+
+    uint64_t ticks(const midi::TempoMap& map, uint64_t microseconds)
+    {
+        return value(map.ticks(microseconds));
+    }
+}
+
+TEST_CASE("TempoMap, default tempo")
+{
+    midi::TempoMap map(480, {});
+
+    CATCH_CHECK(!map.is_smpte());
+    CATCH_CHECK(us(map, 0) == 0);
+    CATCH_CHECK(us(map, 480) == 500000);
+    CATCH_CHECK(us(map, 960 * 60) == 60000000);
+    CATCH_CHECK(ticks(map, 500000) == 480);
+}
+
+TEST_CASE("TempoMap, tempo changes")
+{
+    // 96 ticks per quarter: 1 s per quarter for 96 ticks, then 0.25 s per quarter, then 2 s per quarter
+    midi::TempoMap map(96, { change(192, 2000000), change(96, 250000), change(0, 1000000) });
+
+    CATCH_CHECK(map.segment_count() == 3);
+    CATCH_CHECK(us(map, 48) == 500000);
+    CATCH_CHECK(us(map, 96) == 1000000);
+    CATCH_CHECK(us(map, 144) == 1125000);
+    CATCH_CHECK(us(map, 192) == 1250000);
+    CATCH_CHECK(us(map, 288) == 3250000);
+
+    CATCH_CHECK(ticks(map, 1000000) == 96);
+    CATCH_CHECK(ticks(map, 1125000) == 144);
+    CATCH_CHECK(ticks(map, 3250000) == 288);
+}
+
+TEST_CASE("TempoMap, last change at the same time wins")
+{
+    midi::TempoMap map(100, { change(0, 300000), change(50, 100000), change(50, 200000) });
+
+    CATCH_CHECK(map.segment_count() == 2);
+    CATCH_CHECK(us(map, 150) == 150000 + 200000);
+}
+
+TEST_CASE("TempoMap, ticks is the inverse of microseconds")
+{
+    midi::TempoMap map(7, { change(3, 123457), change(40, 999999), change(41, 1), change(100, 654321) });
+
+    for (uint64_t tick = 0; tick != 300; ++tick)
+    {
+        uint64_t time = us(map, tick);
+
+        CATCH_CHECK(us(map, ticks(map, time)) == time);
+        CATCH_CHECK(us(map, ticks(map, time) + 1) > time);
+        CATCH_CHECK(ticks(map, time) >= tick);
+    }
+}
+
+TEST_CASE("TempoMap, SMPTE division")
+{
+    // 25 frames per second, 40 ticks per frame: one millisecond per tick
+    midi::TempoMap map(uint16_t(uint8_t(-25) << 8 | 40), { change(0, 100) });
+
+    CATCH_CHECK(map.is_smpte());
+    CATCH_CHECK(us(map, 1) == 1000);
+    CATCH_CHECK(us(map, 1000) == 1000000);
+    CATCH_CHECK(ticks(map, 2500) == 2);
+
+    // 29.97 frames per second, one tick per frame
+    midi::TempoMap drop(uint16_t(uint8_t(-29) << 8 | 1), {});
+
+    CATCH_CHECK(us(drop, 30000) == 1001000000);
+}
+
+TEST_CASE("read_tempo_map")
+{
+    std::vector<char> buffer = {
+        MTHD, 0x00, 0x00, 0x00, 0x06, 0x00, 0x01, 0x00, 0x02, 0x00, 0x60,
+        MTRK, 0x00, 0x00, 0x00, 0x12,
+        0x00, SET_TEMPO(1000000),
+        0x60, SET_TEMPO(250000),
+        END_OF_TRACK,
+        MTRK, 0x00, 0x00, 0x00, 0x0F,
+        0x40, NOTE_ON(0, 60, 100),
+        0x40, char(0xFF), 0x51, 0x03, 0x07, char(0xA1), 0x20,
+        END_OF_TRACK,
+    };
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer.data());
+
+    midi::TempoMap map = midi::read_tempo_map(data, buffer.size());
+    std::istringstream in(std::string(buffer.begin(), buffer.end()));
+    midi::TempoMap from_stream = midi::read_tempo_map(in);
+
+    // Second track sets 500000 at tick 128
+    CATCH_CHECK(map.segment_count() == 3);
+    CATCH_CHECK(us(map, 96) == 1000000);
+    CATCH_CHECK(us(map, 128) == 1000000 + 32 * 250000 / 96);
+    CATCH_CHECK(us(map, 224) == 1000000 + 32 * 250000 / 96 + 500000);
+
+    for (uint64_t tick : { 0u, 50u, 100u, 200u, 1000u })
+    {
+        CATCH_CHECK(us(from_stream, tick) == us(map, tick));
+    }
+}
+
+#endif
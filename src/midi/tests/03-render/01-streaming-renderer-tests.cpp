@@ -0,0 +1,115 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "tests/tests-util.h"
+#include "render/streaming-renderer.h"
+#include "imaging/bmp-format.h"
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+
+using testutils::note;
+
+namespace
+{
+    // Full-song rendering the streaming renderer has to agree with
+    imaging::PackedBitmap render_song(const std::vector<midi::NOTE>& notes, unsigned width, uint32_t scale, uint32_t note_height, int low, int high)
+    {
+        imaging::PackedBitmap bitmap(width, (high - low + 1) * note_height);
+
+        for (const auto& n : notes)
+        {
+            for (uint64_t x = value(n.start) / scale; x != value(n.start) / scale + value(n.duration) / scale; ++x)
+            {
+                for (unsigned y = 0; y != note_height; ++y)
+                {
+                    bitmap[Position(unsigned(x), (high - value(n.note_number)) * note_height + y)] = imaging::PackedColor(imaging::colors::cyan());
+                }
+            }
+        }
+
+        return bitmap;
+    }
+
+    bool same_pixels(const imaging::PackedBitmap& a, const imaging::PackedBitmap& b)
+    {
+        if (a.width() != b.width() || a.height() != b.height())
+        {
+            return false;
+        }
+
+        bool result = true;
+        a.for_each_position([&](const Position& p) { result = result && a[p] == b[p]; });
+
+        return result;
+    }
+}
+
+TEST_CASE("StreamingRenderer, dimensions")
+{
+    midi::IntervalTree tree(std::vector<midi::NOTE> { note(60, 0, 10), note(62, 5, 10) });
+    render::StreamingRenderer renderer(tree, 1, 4, midi::NoteNumber(60), midi::NoteNumber(62), 8);
+
+    CATCH_CHECK(renderer.width() == 8);
+    CATCH_CHECK(renderer.height() == 12);
+}
+
+TEST_CASE("StreamingRenderer, single frame")
+{
+    midi::IntervalTree tree(std::vector<midi::NOTE> { note(61, 2, 3) });
+    render::StreamingRenderer renderer(tree, 1, 1, midi::NoteNumber(60), midi::NoteNumber(62), 6);
+    renderer.move_to(0);
+    auto frame = renderer.frame();
+
+    CATCH_CHECK(frame[Position(1, 1)] == imaging::PackedColor());
+    CATCH_CHECK(frame[Position(2, 1)] == imaging::PackedColor(imaging::colors::cyan()));
+    CATCH_CHECK(frame[Position(4, 1)] == imaging::PackedColor(imaging::colors::cyan()));
+    CATCH_CHECK(frame[Position(5, 1)] == imaging::PackedColor());
+    CATCH_CHECK(frame[Position(2, 0)] == imaging::PackedColor());
+    CATCH_CHECK(frame[Position(2, 2)] == imaging::PackedColor());
+}
+
+TEST_CASE("StreamingRenderer, frames agree with slices of the full song")
+{
+    std::vector<midi::NOTE> notes;
+
+    for (unsigned i = 0; i != 200; ++i)
+    {
+        notes.push_back(note(40 + (i * 7) % 20, (i * 37) % 1000, (i * 13) % 120));
+    }
+
+    const uint32_t scale = 3;
+    const uint32_t note_height = 2;
+    const unsigned frame_width = 40;
+    unsigned song_width = 0;
+
+    for (const auto& n : notes)
+    {
+        song_width = std::max(song_width, unsigned(value(n.start + n.duration) / scale));
+    }
+
+    midi::IntervalTree tree(notes);
+    imaging::PackedBitmap song = render_song(notes, song_width, scale, note_height, 40, 59);
+
+    for (unsigned step : { 1u, 7u, 40u, 55u })
+    {
+        render::StreamingRenderer renderer(tree, scale, note_height, midi::NoteNumber(40), midi::NoteNumber(59), frame_width);
+
+        for (unsigned x = 0; x + frame_width <= song_width; x += step)
+        {
+            renderer.move_to(x);
+
+            CATCH_CHECK(same_pixels(renderer.frame(), *song.slice(x, 0, frame_width, song.height())));
+
+            std::ostringstream expected, actual;
+            imaging::save_as_bmp(expected, renderer.frame());
+            renderer.write_bmp(actual);
+
+            CATCH_CHECK(actual.str() == expected.str());
+        }
+    }
+}
+
+#endif
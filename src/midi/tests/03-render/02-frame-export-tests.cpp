@@ -0,0 +1,115 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "tests/tests-util.h"
+#include "render/frame-export.h"
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using testutils::note;
+
+namespace
+{
+    std::vector<std::string> export_to_strings(const midi::IntervalTree& tree, unsigned count, unsigned step, unsigned workers)
+    {
+        std::vector<std::string> frames(count);
+        std::vector<unsigned> writes(count);
+        std::mutex lock;
+
+        render::export_frames(count, step, workers, [&tree]() {
+            return render::StreamingRenderer(tree, 2, 3, midi::NoteNumber(30), midi::NoteNumber(50), 25);
+        }, [&](unsigned i, const render::StreamingRenderer& frame) {
+            std::ostringstream out;
+            frame.write_bmp(out);
+
+            std::lock_guard<std::mutex> guard(lock);
+            frames[i] = out.str();
+            ++writes[i];
+        });
+
+        for (unsigned w : writes)
+        {
+            CATCH_CHECK(w == 1);
+        }
+
+        return frames;
+    }
+}
+
+TEST_CASE("frame_count")
+{
+    CATCH_CHECK(render::frame_count(100, 10, 1) == 91);
+    CATCH_CHECK(render::frame_count(100, 10, 3) == 31);
+    CATCH_CHECK(render::frame_count(100, 100, 7) == 1);
+    CATCH_CHECK(render::frame_count(9, 10, 1) == 0);
+}
+
+TEST_CASE("timed_frame_positions")
+{
+    // 96 ticks per quarter at 120 bpm is 192 ticks per second; 2 ticks per column makes 96 columns per second
+    midi::TempoMap constant(96, {});
+    auto positions = render::timed_frame_positions(constant, 2, 24, 100, 10);
+
+    CATCH_REQUIRE(positions.size() == 23);
+    for (unsigned i = 0; i != positions.size(); ++i)
+    {
+        CATCH_CHECK(positions[i] == i * 4);
+    }
+
+    // Twice as fast after the first second
+    midi::TempoMap faster(96, { midi::TempoChange{ midi::Time(192), 250000 } });
+    auto sped_up = render::timed_frame_positions(faster, 2, 24, 1000, 10);
+
+    CATCH_CHECK(sped_up[24] == 96);
+    CATCH_CHECK(sped_up[25] == 104);
+    CATCH_CHECK(sped_up.back() <= 990);
+    CATCH_CHECK(sped_up.size() == 24 + (990 - 96) / 8 + 1);
+
+    CATCH_CHECK(render::timed_frame_positions(constant, 2, 24, 9, 10).empty());
+    CATCH_CHECK(render::timed_frame_positions(constant, 2, 24, 10, 10).size() == 1);
+}
+
+TEST_CASE("export_frames, at given positions")
+{
+    midi::IntervalTree tree(std::vector<midi::NOTE> { note(30, 0, 40), note(40, 25, 100), note(50, 90, 7) });
+    std::vector<unsigned> positions = { 0, 0, 3, 30, 31, 60 };
+    std::vector<std::string> frames(positions.size());
+
+    render::export_frames(positions, 3, [&tree]() {
+        return render::StreamingRenderer(tree, 2, 3, midi::NoteNumber(30), midi::NoteNumber(50), 25);
+    }, [&](unsigned i, const render::StreamingRenderer& frame) {
+        std::ostringstream out;
+        frame.write_bmp(out);
+        frames[i] = out.str();
+    });
+
+    for (unsigned i = 0; i != positions.size(); ++i)
+    {
+        render::StreamingRenderer renderer(tree, 2, 3, midi::NoteNumber(30), midi::NoteNumber(50), 25);
+        renderer.move_to(positions[i]);
+        std::ostringstream out;
+        renderer.write_bmp(out);
+
+        CATCH_CHECK(frames[i] == out.str());
+    }
+}
+
+TEST_CASE("export_frames, parallel output equals serial output")
+{
+    midi::IntervalTree tree(testutils::scattered_notes());
+
+    for (unsigned step : { 1u, 4u, 30u })
+    {
+        unsigned count = render::frame_count(330, 25, step);
+        auto serial = export_to_strings(tree, count, step, 1);
+
+        CATCH_CHECK(export_to_strings(tree, count, step, 4) == serial);
+        CATCH_CHECK(export_to_strings(tree, count, step, 0) == serial);
+    }
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "tests/tests-util.h"
+#include "render/frame-export.h"
+#include "render/y4m-sink.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using testutils::note;
+
+namespace
+{
+    class RecordingSink final : public render::FrameSink
+    {
+    public:
+        std::vector<unsigned> indices;
+
+        bool is_sequential() const override { return true; }
+        void write(unsigned index, const render::StreamingRenderer&) override { indices.push_back(index); }
+    };
+
+    std::string export_y4m(const midi::IntervalTree& tree, unsigned count, unsigned workers)
+    {
+        std::ostringstream out;
+        render::Y4mSink sink(out, 25);
+
+        render::export_frames(count, 3, workers, [&tree]() {
+            return render::StreamingRenderer(tree, 1, 2, midi::NoteNumber(10), midi::NoteNumber(20), 16);
+        }, sink);
+
+        return out.str();
+    }
+}
+
+TEST_CASE("BmpFileSink, path")
+{
+    render::BmpFileSink sink("out/frame%d.bmp");
+
+    CATCH_CHECK(sink.path(0) == "out/frame00000.bmp");
+    CATCH_CHECK(sink.path(123) == "out/frame00123.bmp");
+    CATCH_CHECK(!sink.is_sequential());
+}
+
+TEST_CASE("Frame patterns need a placeholder")
+{
+    CATCH_CHECK(render::is_frame_pattern("out/frame%d.bmp"));
+    CATCH_CHECK(render::is_frame_pattern("%d"));
+    CATCH_CHECK(!render::is_frame_pattern("out/frame.bmp"));
+    CATCH_CHECK(!render::is_frame_pattern("out/frame%.bmp"));
+    CATCH_CHECK(!render::is_frame_pattern(""));
+}
+
+TEST_CASE("BmpFileSink, through an AsyncFileWriter")
+{
+    midi::IntervalTree tree(std::vector<midi::NOTE> { note(1, 1, 2), note(0, 3, 5) });
+    render::StreamingRenderer renderer(tree, 1, 2, midi::NoteNumber(0), midi::NoteNumber(1), 6);
+    std::vector<std::string> expected;
+
+    {
+        io::AsyncFileWriter writer(1);
+        render::BmpFileSink sink("frame-sink-test-%d.bmp", imaging::BmpCompression::None, &writer);
+
+        for (unsigned i = 0; i != 4; ++i)
+        {
+            renderer.move_to(i);
+            sink.write(i, renderer);
+
+            std::ostringstream out;
+            renderer.write_bmp(out);
+            expected.push_back(out.str());
+        }
+
+        CATCH_CHECK(writer.finish());
+    }
+
+    for (unsigned i = 0; i != 4; ++i)
+    {
+        std::string path = render::frame_path("frame-sink-test-%d.bmp", i);
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream written;
+        written << in.rdbuf();
+        in.close();
+
+        CATCH_CHECK(written.str() == expected[i]);
+        std::remove(path.c_str());
+    }
+}
+
+TEST_CASE("Y4mSink, header and pixels")
+{
+    midi::IntervalTree tree(std::vector<midi::NOTE> { note(1, 1, 2) });
+    render::StreamingRenderer renderer(tree, 1, 1, midi::NoteNumber(0), midi::NoteNumber(1), 4);
+    std::ostringstream out;
+    render::Y4mSink sink(out, 30);
+
+    renderer.move_to(0);
+    sink.write(0, renderer);
+    sink.write(1, renderer);
+
+    std::string header = "YUV4MPEG2 W4 H2 F30:1 Ip A1:1 C444\n";
+    std::string frame = "FRAME\n";
+    std::string y4m = out.str();
+
+    CATCH_REQUIRE(y4m.size() == header.size() + 2 * (frame.size() + 3 * 8));
+    CATCH_CHECK(y4m.substr(0, header.size() + frame.size()) == header + frame);
+
+    // Top row holds note 1 in columns 1 and 2, in cyan; everything else is black
+    const uint8_t* planes = reinterpret_cast<const uint8_t*>(y4m.data() + header.size() + frame.size());
+    CATCH_CHECK(planes[0] == 16);
+    CATCH_CHECK(planes[1] == 169);
+    CATCH_CHECK(planes[2] == 169);
+    CATCH_CHECK(planes[3] == 16);
+    CATCH_CHECK(planes[4] == 16);
+    CATCH_CHECK(planes[8 + 0] == 128);
+    CATCH_CHECK(planes[8 + 1] == 166);
+    CATCH_CHECK(planes[16 + 0] == 128);
+    CATCH_CHECK(planes[16 + 1] == 16);
+}
+
+TEST_CASE("export_frames, sequential sink gets frames in order")
+{
+    std::vector<midi::NOTE> notes;
+
+    for (unsigned i = 0; i != 100; ++i)
+    {
+        notes.push_back(note(10 + i % 11, (i * 17) % 200, (i * 5) % 40));
+    }
+
+    midi::IntervalTree tree(notes);
+    RecordingSink sink;
+
+    render::export_frames(50, 2, 4, [&tree]() {
+        return render::StreamingRenderer(tree, 1, 1, midi::NoteNumber(10), midi::NoteNumber(20), 10);
+    }, sink);
+
+    CATCH_REQUIRE(sink.indices.size() == 50);
+    for (unsigned i = 0; i != 50; ++i)
+    {
+        CATCH_CHECK(sink.indices[i] == i);
+    }
+
+    CATCH_CHECK(export_y4m(tree, 60, 4) == export_y4m(tree, 60, 1));
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "tests/tests-util.h"
+#include "render/raw-sink.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using testutils::note;
+
+namespace
+{
+    // Frame pixels, rows top to bottom, as BGRA bytes
+    std::string bgra(const render::StreamingRenderer& renderer)
+    {
+        auto frame = renderer.frame();
+        std::string result;
+
+        for (unsigned y = 0; y != frame.height(); ++y)
+        {
+            result.append(reinterpret_cast<const char*>(frame.view().row(y)), 4 * frame.width());
+        }
+
+        return result;
+    }
+}
+
+TEST_CASE("RawSink, BGRA frames are appended without headers")
+{
+    midi::IntervalTree tree(std::vector<midi::NOTE> { note(5, 2, 6), note(6, 0, 3), note(7, 9, 4) });
+    render::StreamingRenderer renderer(tree, 1, 2, midi::NoteNumber(5), midi::NoteNumber(7), 5);
+    std::ostringstream out;
+    std::string expected;
+
+    {
+        render::RawSink sink(out, render::RawSink::Format::BGRA, 16);
+
+        for (unsigned i = 0; i != 4; ++i)
+        {
+            renderer.move_to(i * 3);
+            sink.write(i, renderer);
+            expected += bgra(renderer);
+        }
+    }
+
+    CATCH_CHECK(expected.size() == 4 * 5 * 6 * 4);
+    CATCH_CHECK(out.str() == expected);
+}
+
+TEST_CASE("RawSink, RGB")
+{
+    midi::IntervalTree tree(std::vector<midi::NOTE> { note(1, 1, 1) });
+    render::StreamingRenderer renderer(tree, 1, 1, midi::NoteNumber(0), midi::NoteNumber(1), 2);
+    std::ostringstream out;
+    render::RawSink sink(out, render::RawSink::Format::RGB);
+
+    renderer.move_to(0);
+    sink.write(0, renderer);
+    sink.flush();
+
+    CATCH_CHECK(out.str() == std::string("\x00\x00\x00\x00\xff\xff\x00\x00\x00\x00\x00\x00", 12));
+}
+
+#endif
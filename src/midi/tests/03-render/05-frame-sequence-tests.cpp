@@ -0,0 +1,128 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "tests/tests-util.h"
+#include "render/frame-export.h"
+#include "render/frame-sequence.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    render::StreamingRenderer create_renderer(const midi::IntervalTree& tree)
+    {
+        return render::StreamingRenderer(tree, 2, 3, midi::NoteNumber(30), midi::NoteNumber(50), 25);
+    }
+
+    std::string export_sequence(const midi::IntervalTree& tree, unsigned count, unsigned step, unsigned keyframe_interval)
+    {
+        std::ostringstream out;
+        render::SequenceSink sink(out, render::sequence::DEFAULT_LEVEL, keyframe_interval);
+
+        render::export_frames(count, step, 2, [&tree]() { return create_renderer(tree); }, sink);
+
+        return out.str();
+    }
+
+    bool same_pixels(const imaging::PackedBitmap& a, const imaging::PackedBitmap& b)
+    {
+        bool result = a.width() == b.width() && a.height() == b.height();
+
+        a.for_each_position([&](const Position& p) { result = result && a[p] == b[p]; });
+
+        return result;
+    }
+
+    // Expands the sequence and compares every frame with a direct rendering
+    void check_frames(const midi::IntervalTree& tree, const std::string& sequence, unsigned count, unsigned step)
+    {
+        std::istringstream in(sequence);
+        render::SequenceReader reader(in);
+        render::StreamingRenderer renderer = create_renderer(tree);
+
+        CATCH_CHECK(reader.width() == renderer.width());
+        CATCH_CHECK(reader.height() == renderer.height());
+
+        for (unsigned i = 0; i != count; ++i)
+        {
+            CATCH_REQUIRE(reader.next());
+            renderer.move_to(i * step);
+
+            CATCH_CHECK(same_pixels(reader.frame(), renderer.frame()));
+        }
+
+        CATCH_CHECK(!reader.next());
+    }
+
+    uint8_t record_type(const std::string& sequence, size_t* offset)
+    {
+        uint8_t type = uint8_t(sequence[*offset]);
+        uint32_t size = 0;
+
+        for (int i = 3; i >= 0; --i)
+        {
+            size = (size << 8) | uint8_t(sequence[*offset + 5 + i]);
+        }
+
+        *offset += 9 + size;
+
+        return type;
+    }
+}
+
+TEST_CASE("SequenceSink, header")
+{
+    midi::IntervalTree tree(testutils::scattered_notes());
+    std::string sequence = export_sequence(tree, 1, 1, 0);
+
+    CATCH_CHECK(sequence.substr(0, 16) == std::string("PRSQ\x01\x00\x10\x00\x19\x00\x00\x00\x3f\x00\x00\x00", 16));
+}
+
+TEST_CASE("SequenceSink, expands back to the rendered frames")
+{
+    midi::IntervalTree tree(testutils::scattered_notes());
+
+    for (unsigned step : { 1u, 4u, 24u, 25u, 60u })
+    {
+        unsigned count = render::frame_count(330, 25, step);
+
+        check_frames(tree, export_sequence(tree, count, step, 0), count, step);
+        check_frames(tree, export_sequence(tree, count, step, 5), count, step);
+    }
+}
+
+TEST_CASE("SequenceSink, keyframes")
+{
+    midi::IntervalTree tree(testutils::scattered_notes());
+    std::string deltas = export_sequence(tree, 12, 3, 0);
+    std::string periodic = export_sequence(tree, 12, 3, 4);
+    std::string jumps = export_sequence(tree, 4, 30, 0);
+    std::vector<uint8_t> types;
+
+    for (size_t offset = 16; offset < periodic.size(); )
+    {
+        types.push_back(record_type(periodic, &offset));
+    }
+
+    CATCH_CHECK(types == std::vector<uint8_t> { 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1 });
+
+    size_t offset = 16;
+    CATCH_CHECK(record_type(deltas, &offset) == render::sequence::KEYFRAME);
+    while (offset < deltas.size())
+    {
+        CATCH_CHECK(record_type(deltas, &offset) == render::sequence::DELTA);
+    }
+
+    offset = 16;
+    while (offset < jumps.size())
+    {
+        CATCH_CHECK(record_type(jumps, &offset) == render::sequence::KEYFRAME);
+    }
+
+    CATCH_CHECK(deltas.size() < periodic.size());
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "Catch.h"
+#include <sstream>
+
+
+TEST_CASE("PackedColor, is four bytes in BMP order")
+{
+    imaging::PackedColor c(1, 2, 3);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&c);
+
+    CATCH_CHECK(sizeof(imaging::PackedColor) == 4);
+    CATCH_CHECK(bytes[0] == 3);
+    CATCH_CHECK(bytes[1] == 2);
+    CATCH_CHECK(bytes[2] == 1);
+    CATCH_CHECK(bytes[3] == 255);
+}
+
+TEST_CASE("PackedColor, from Color")
+{
+    bool round_trips = imaging::PackedColor(imaging::colors::white()).to_color() == imaging::colors::white();
+
+    CATCH_CHECK(imaging::PackedColor(imaging::colors::black()) == imaging::PackedColor(0, 0, 0));
+    CATCH_CHECK(imaging::PackedColor(imaging::colors::cyan()) == imaging::PackedColor(0, 255, 255));
+    CATCH_CHECK(imaging::PackedColor(imaging::colors::orange()) == imaging::PackedColor(255, 163, 0));
+    CATCH_CHECK(round_trips);
+}
+
+TEST_CASE("PackedBitmap, initialized to black")
+{
+    imaging::PackedBitmap bitmap(3, 2);
+
+    CATCH_CHECK(bitmap.width() == 3);
+    CATCH_CHECK(bitmap.height() == 2);
+    CATCH_CHECK(bitmap[Position(2, 1)] == imaging::PackedColor());
+}
+
+TEST_CASE("PackedBitmap, BMP output matches Bitmap")
+{
+    auto color = [](const Position& p) { return imaging::Color(p.x / 7.0, p.y / 5.0, (p.x + p.y) / 12.0); };
+    imaging::Bitmap bitmap(7, 5, color);
+    imaging::PackedBitmap packed(7, 5, [&color](const Position& p) { return imaging::PackedColor(color(p)); });
+    std::ostringstream expected, actual;
+
+    imaging::save_as_bmp(expected, bitmap);
+    imaging::save_as_bmp(actual, packed);
+
+    CATCH_CHECK(actual.str() == expected.str());
+}
+
+TEST_CASE("PackedBitmap, BMP output of a slice")
+{
+    imaging::PackedBitmap bitmap(6, 6, [](const Position& p) { return imaging::PackedColor(uint8_t(p.x), uint8_t(p.y), 0); });
+    auto slice = bitmap.slice(2, 1, 3, 4);
+    imaging::PackedBitmap copy(3, 4, [&slice](const Position& p) { return (*slice)[p]; });
+    std::ostringstream expected, actual;
+
+    imaging::save_as_bmp(expected, copy);
+    imaging::save_as_bmp(actual, *slice);
+
+    CATCH_CHECK(actual.str() == expected.str());
+    CATCH_CHECK((*slice)[Position(0, 0)] == imaging::PackedColor(2, 1, 0));
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "Catch.h"
+
+
+TEST_CASE("GridView, of ConcreteGrid")
+{
+    ConcreteGrid<int> grid(4, 3, [](const Position& p) { return int(p.x + 10 * p.y); });
+    auto view = grid.view();
+
+    CATCH_CHECK(view.width() == 4);
+    CATCH_CHECK(view.height() == 3);
+    CATCH_CHECK(view.stride() == 4);
+    CATCH_CHECK(view.row(2)[1] == 21);
+    CATCH_CHECK(view[Position(3, 1)] == 13);
+
+    view[Position(0, 1)] = -1;
+
+    CATCH_CHECK(grid[Position(0, 1)] == -1);
+}
+
+TEST_CASE("GridView, of SubGrid")
+{
+    auto grid = std::make_shared<ConcreteGrid<int>>(5, 5, [](const Position& p) { return int(p.x + 10 * p.y); });
+    auto sub = subgrid<int>(grid, Position(1, 2), 3, 2);
+    auto nested = subgrid<int>(sub, Position(1, 1), 2, 1);
+    auto view = sub->view();
+
+    CATCH_CHECK(view.width() == 3);
+    CATCH_CHECK(view.height() == 2);
+    CATCH_CHECK(view.stride() == 5);
+    CATCH_CHECK(view.row(0)[0] == 21);
+    CATCH_CHECK(view.row(1)[2] == 33);
+    CATCH_CHECK(nested->view().row(0)[0] == 32);
+}
+
+TEST_CASE("Bitmap, view of a slice")
+{
+    imaging::PackedBitmap bitmap(6, 4);
+    auto slice = bitmap.slice(1, 1, 3, 2);
+
+    slice->clear(imaging::PackedColor(255, 0, 0));
+
+    const imaging::PackedBitmap& readonly = bitmap;
+    auto view = readonly.view();
+
+    CATCH_CHECK(view[Position(0, 1)] == imaging::PackedColor());
+    CATCH_CHECK(view[Position(1, 1)] == imaging::PackedColor(255, 0, 0));
+    CATCH_CHECK(view[Position(3, 2)] == imaging::PackedColor(255, 0, 0));
+    CATCH_CHECK(view[Position(4, 2)] == imaging::PackedColor());
+    CATCH_CHECK(view[Position(1, 3)] == imaging::PackedColor());
+}
+
+#endif
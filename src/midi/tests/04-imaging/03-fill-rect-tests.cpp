@@ -0,0 +1,75 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "Catch.h"
+
+
+namespace
+{
+    const imaging::PackedColor red(255, 0, 0);
+
+    // True if the red pixels form exactly the rectangle [left, right) x [top, bottom)
+    bool is_filled(const imaging::PackedBitmap& bitmap, unsigned left, unsigned top, unsigned right, unsigned bottom)
+    {
+        bool result = true;
+
+        bitmap.for_each_position([&](const Position& p) {
+            bool inside = left <= p.x && p.x < right && top <= p.y && p.y < bottom;
+
+            result = result && (bitmap[p] == red) == inside;
+        });
+
+        return result;
+    }
+}
+
+TEST_CASE("fill_rect, inside")
+{
+    imaging::PackedBitmap bitmap(8, 6);
+    bitmap.fill_rect(2, 1, 3, 4, red);
+
+    CATCH_CHECK(is_filled(bitmap, 2, 1, 5, 5));
+}
+
+TEST_CASE("fill_rect, clipped")
+{
+    imaging::PackedBitmap bitmap(8, 6);
+    bitmap.fill_rect(-2, 4, 5, 10, red);
+
+    CATCH_CHECK(is_filled(bitmap, 0, 4, 3, 6));
+}
+
+TEST_CASE("fill_rect, entirely outside or empty")
+{
+    imaging::PackedBitmap bitmap(8, 6);
+    bitmap.fill_rect(8, 0, 3, 3, red);
+    bitmap.fill_rect(-5, 0, 5, 3, red);
+    bitmap.fill_rect(1, 1, 0, 3, red);
+    bitmap.fill_rect(1, 1, 3, -1, red);
+
+    CATCH_CHECK(is_filled(bitmap, 0, 0, 0, 0));
+}
+
+TEST_CASE("fill_rect, on a slice stays within the slice")
+{
+    imaging::PackedBitmap bitmap(8, 6);
+    auto slice = bitmap.slice(2, 2, 3, 3);
+    slice->fill_rect(1, 1, 10, 10, red);
+
+    CATCH_CHECK(is_filled(bitmap, 3, 3, 5, 5));
+}
+
+TEST_CASE("fill_rect, on a color Bitmap")
+{
+    imaging::Bitmap bitmap(4, 4);
+    bitmap.fill_rect(1, 0, 2, 1, imaging::colors::cyan());
+    bool filled = bitmap[Position(1, 0)] == imaging::colors::cyan() && bitmap[Position(2, 0)] == imaging::colors::cyan();
+    bool untouched = bitmap[Position(0, 0)] == imaging::colors::black() && bitmap[Position(1, 1)] == imaging::colors::black();
+
+    CATCH_CHECK(filled);
+    CATCH_CHECK(untouched);
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "Catch.h"
+#include <sstream>
+#include <string>
+
+
+namespace
+{
+    std::string bmp(const imaging::Bitmap& bitmap)
+    {
+        std::ostringstream out;
+        imaging::save_as_bmp(out, bitmap);
+
+        return out.str();
+    }
+
+    std::string bmp(const imaging::PackedBitmap& bitmap)
+    {
+        std::ostringstream out;
+        imaging::save_as_bmp(out, bitmap);
+
+        return out.str();
+    }
+}
+
+TEST_CASE("save_as_bmp, color conversion truncates each component")
+{
+    const double values[] = { 0, 1, 0.5, 0.999, 0.001, 1.0 / 255, 254.999 / 255, 0.64 };
+
+    for (unsigned width = 1; width != 12; ++width)
+    {
+        auto color = [&values](const Position& p) {
+            return imaging::Color(values[(p.x + p.y) % 8], values[(p.x * 3 + 1) % 8], values[(p.x * 5 + p.y + 2) % 8]);
+        };
+        imaging::Bitmap bitmap(width, 3, color);
+        imaging::PackedBitmap packed(width, 3, [&color](const Position& p) { return imaging::PackedColor(color(p)); });
+
+        CATCH_CHECK(bmp(bitmap) == bmp(packed));
+    }
+}
+
+TEST_CASE("save_as_bmp, slice of a color bitmap")
+{
+    imaging::Bitmap bitmap(9, 5, [](const Position& p) { return imaging::Color(p.x / 8.0, p.y / 4.0, 0.25); });
+    auto slice = bitmap.slice(1, 2, 6, 3);
+    imaging::Bitmap copy(6, 3, [&slice](const Position& p) { return (*slice)[p]; });
+
+    CATCH_CHECK(bmp(*slice) == bmp(copy));
+}
+
+TEST_CASE("save_as_bmp, rotated columns")
+{
+    imaging::PackedBitmap ring(5, 2, [](const Position& p) { return imaging::PackedColor(uint8_t(p.x), uint8_t(p.y), 0); });
+    imaging::PackedBitmap rotated(5, 2, [](const Position& p) { return imaging::PackedColor(uint8_t((p.x + 3) % 5), uint8_t(p.y), 0); });
+
+    for (unsigned first_column : { 0u, 3u })
+    {
+        std::ostringstream out;
+        imaging::save_as_bmp(out, ring, first_column);
+
+        CATCH_CHECK(out.str() == bmp(first_column == 0 ? ring : rotated));
+    }
+}
+
+#endif
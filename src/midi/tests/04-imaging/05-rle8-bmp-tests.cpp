@@ -0,0 +1,157 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/bmp-format.h"
+#include "Catch.h"
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    template<typename T>
+    T read_at(const std::string& bytes, size_t offset)
+    {
+        T result;
+        memcpy(&result, bytes.data() + offset, sizeof(T));
+
+        return result;
+    }
+
+    std::string rle8(const imaging::PackedBitmap& bitmap, unsigned first_column = 0)
+    {
+        std::ostringstream out;
+        imaging::save_as_bmp(out, bitmap, first_column, imaging::BmpCompression::RLE8);
+
+        return out.str();
+    }
+
+    // Minimal BI_RLE8 reader, good enough to check what the writer produces
+    imaging::PackedBitmap decode(const std::string& bmp)
+    {
+        CATCH_REQUIRE(bmp.substr(0, 2) == "BM");
+        CATCH_REQUIRE(read_at<uint32_t>(bmp, 2) == bmp.size());
+        CATCH_REQUIRE(read_at<uint16_t>(bmp, 28) == 8);
+        CATCH_REQUIRE(read_at<uint32_t>(bmp, 30) == 1);
+
+        unsigned width = read_at<int32_t>(bmp, 18);
+        unsigned height = read_at<int32_t>(bmp, 22);
+        uint32_t colors = read_at<uint32_t>(bmp, 46);
+        size_t palette = 14 + read_at<uint32_t>(bmp, 14);
+        size_t data = read_at<uint32_t>(bmp, 10);
+
+        CATCH_REQUIRE(data == palette + 4 * colors);
+
+        imaging::PackedBitmap result(width, height);
+        auto pixel = [&](unsigned x, unsigned y, uint8_t index) {
+            CATCH_REQUIRE(index < colors);
+            CATCH_REQUIRE(x < width);
+            const uint8_t* entry = reinterpret_cast<const uint8_t*>(bmp.data() + palette + 4 * index);
+            result[Position(x, height - 1 - y)] = imaging::PackedColor(entry[2], entry[1], entry[0]);
+        };
+
+        unsigned x = 0, y = 0;
+        size_t i = data;
+
+        while (true)
+        {
+            CATCH_REQUIRE(i + 1 < bmp.size());
+            uint8_t count = bmp[i++];
+            uint8_t value = bmp[i++];
+
+            if (count != 0)
+            {
+                for (unsigned k = 0; k != count; ++k)
+                {
+                    pixel(x++, y, value);
+                }
+            }
+            else if (value == 0)
+            {
+                CATCH_REQUIRE(x == width);
+                x = 0;
+                ++y;
+            }
+            else if (value == 1)
+            {
+                break;
+            }
+            else
+            {
+                CATCH_REQUIRE(value >= 3);
+
+                for (unsigned k = 0; k != value; ++k)
+                {
+                    pixel(x++, y, bmp[i++]);
+                }
+
+                i += value % 2;
+            }
+        }
+
+        CATCH_CHECK(y == height);
+        CATCH_CHECK(i == bmp.size());
+
+        return result;
+    }
+
+    bool same_pixels(const imaging::PackedBitmap& a, const imaging::PackedBitmap& b)
+    {
+        bool result = a.width() == b.width() && a.height() == b.height();
+
+        a.for_each_position([&](const Position& p) { result = result && a[p] == b[p]; });
+
+        return result;
+    }
+}
+
+TEST_CASE("RLE8, piano roll like frame")
+{
+    imaging::PackedBitmap bitmap(300, 40);
+    bitmap.fill_rect(10, 4, 100, 4, imaging::PackedColor(imaging::colors::cyan()));
+    bitmap.fill_rect(150, 20, 140, 4, imaging::PackedColor(imaging::colors::cyan()));
+    bitmap.fill_rect(0, 36, 300, 4, imaging::PackedColor(imaging::colors::orange()));
+
+    std::string compressed = rle8(bitmap);
+    std::ostringstream uncompressed;
+    imaging::save_as_bmp(uncompressed, bitmap);
+
+    CATCH_CHECK(same_pixels(decode(compressed), bitmap));
+    CATCH_CHECK(compressed.size() * 10 < uncompressed.str().size());
+}
+
+TEST_CASE("RLE8, literal stretches and long runs")
+{
+    for (unsigned width : { 1u, 2u, 3u, 4u, 7u, 254u, 255u, 256u, 600u })
+    {
+        imaging::PackedBitmap bitmap(width, 6, [](const Position& p) {
+            unsigned v = p.y < 2 ? p.x * 7 + p.y : (p.y < 4 ? p.x / 3 : (p.x % 5 == 0 ? 1 : 0));
+            return imaging::PackedColor(uint8_t(v % 13), uint8_t(v % 11 * 20), 0);
+        });
+
+        CATCH_CHECK(same_pixels(decode(rle8(bitmap)), bitmap));
+    }
+}
+
+TEST_CASE("RLE8, rotated columns")
+{
+    imaging::PackedBitmap ring(9, 3, [](const Position& p) { return imaging::PackedColor(uint8_t(p.x / 2), uint8_t(p.y), 0); });
+    imaging::PackedBitmap rotated(9, 3, [&ring](const Position& p) { return ring[Position((p.x + 4) % 9, p.y)]; });
+
+    CATCH_CHECK(same_pixels(decode(rle8(ring, 4)), rotated));
+}
+
+TEST_CASE("RLE8, falls back to 32 bits beyond 256 colors")
+{
+    imaging::PackedBitmap bitmap(20, 20, [](const Position& p) { return imaging::PackedColor(uint8_t(p.x), uint8_t(p.y), 0); });
+    std::ostringstream uncompressed;
+    imaging::save_as_bmp(uncompressed, bitmap);
+
+    CATCH_CHECK(rle8(bitmap) == uncompressed.str());
+}
+
+#endif
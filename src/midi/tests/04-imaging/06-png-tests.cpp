@@ -0,0 +1,247 @@
+#ifdef TEST_BUILD
+#define CATCH_CONFIG_PREFIX_ALL
+#define TEST_CASE CATCH_TEST_CASE
+
+#include "imaging/bitmap.h"
+#include "imaging/png-format.h"
+#include "io/deflate.h"
+#include "io/inflate.h"
+#include "Catch.h"
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    uint32_t big_endian(const std::string& bytes, size_t offset)
+    {
+        uint32_t result = 0;
+
+        for (size_t i = 0; i != 4; ++i)
+        {
+            result = (result << 8) | uint8_t(bytes[offset + i]);
+        }
+
+        return result;
+    }
+
+    uint32_t crc32(const std::string& bytes)
+    {
+        uint32_t crc = 0xFFFFFFFFu;
+
+        for (char c : bytes)
+        {
+            crc ^= uint8_t(c);
+
+            for (int k = 0; k != 8; ++k)
+            {
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+            }
+        }
+
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    std::string unzlib(const std::string& zlib)
+    {
+        std::vector<uint8_t> result = io::inflate(reinterpret_cast<const uint8_t*>(zlib.data()), zlib.size());
+
+        return std::string(result.begin(), result.end());
+    }
+
+    uint8_t paeth(int a, int b, int c)
+    {
+        int p = a + b - c;
+        int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+
+        return uint8_t(pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+    }
+
+    // Reads an 8-bit RGB, non-interlaced PNG as produced by save_as_png
+    imaging::PackedBitmap decode(const std::string& png)
+    {
+        CATCH_REQUIRE(png.substr(0, 8) == std::string("\x89PNG\r\n\x1A\n", 8));
+
+        std::string header, idat;
+        size_t offset = 8;
+        bool ended = false;
+
+        while (!ended)
+        {
+            CATCH_REQUIRE(offset + 12 <= png.size());
+            uint32_t length = big_endian(png, offset);
+            std::string type = png.substr(offset + 4, 4);
+            CATCH_REQUIRE(offset + 12 + length <= png.size());
+            std::string data = png.substr(offset + 8, length);
+
+            CATCH_CHECK(big_endian(png, offset + 8 + length) == crc32(type + data));
+
+            if (type == "IHDR") header = data;
+            else if (type == "IDAT") idat += data;
+            else if (type == "IEND") ended = true;
+
+            offset += 12 + length;
+        }
+
+        CATCH_CHECK(offset == png.size());
+        CATCH_REQUIRE(header.size() == 13);
+        CATCH_REQUIRE(header.substr(8) == std::string("\x08\x02\x00\x00\x00", 5));
+
+        unsigned width = big_endian(header, 0);
+        unsigned height = big_endian(header, 4);
+        size_t stride = size_t(width) * 3;
+        std::string filtered = unzlib(idat);
+        CATCH_REQUIRE(filtered.size() == height * (stride + 1));
+
+        imaging::PackedBitmap result(width, height);
+        std::vector<uint8_t> above(stride, 0), row(stride);
+
+        for (unsigned y = 0; y != height; ++y)
+        {
+            uint8_t filter = uint8_t(filtered[y * (stride + 1)]);
+            CATCH_REQUIRE(filter <= 4);
+
+            for (size_t i = 0; i != stride; ++i)
+            {
+                int a = i >= 3 ? row[i - 3] : 0, b = above[i], c = i >= 3 ? above[i - 3] : 0;
+                int predictor[] = { 0, a, b, (a + b) / 2, paeth(a, b, c) };
+                row[i] = uint8_t(uint8_t(filtered[y * (stride + 1) + 1 + i]) + predictor[filter]);
+            }
+
+            for (unsigned x = 0; x != width; ++x)
+            {
+                result[Position(x, y)] = imaging::PackedColor(row[3 * x], row[3 * x + 1], row[3 * x + 2]);
+            }
+
+            above = row;
+        }
+
+        return result;
+    }
+
+    std::string png(const imaging::PackedBitmap& bitmap, int level)
+    {
+        std::ostringstream out;
+        imaging::save_as_png(out, bitmap, level);
+
+        return out.str();
+    }
+
+    bool same_pixels(const imaging::PackedBitmap& a, const imaging::PackedBitmap& b)
+    {
+        bool result = a.width() == b.width() && a.height() == b.height();
+
+        a.for_each_position([&](const Position& p) { result = result && a[p] == b[p]; });
+
+        return result;
+    }
+
+    imaging::PackedBitmap piano_roll(unsigned width, unsigned height)
+    {
+        imaging::PackedBitmap bitmap(width, height);
+
+        for (unsigned i = 0; i != 40; ++i)
+        {
+            bitmap.fill_rect((i * 37) % width, (i * 13) % height, 20 + i % 50, 4, imaging::PackedColor(imaging::colors::cyan()));
+        }
+
+        return bitmap;
+    }
+}
+
+TEST_CASE("PNG, round trip at every level")
+{
+    imaging::PackedBitmap bitmap(37, 23, [](const Position& p) {
+        return imaging::PackedColor(uint8_t(p.x * 7), uint8_t(p.y * 11 + p.x), uint8_t((p.x ^ p.y) * 5));
+    });
+
+    for (int level = 0; level <= 9; ++level)
+    {
+        CATCH_CHECK(same_pixels(decode(png(bitmap, level)), bitmap));
+    }
+}
+
+TEST_CASE("PNG, piano roll compresses")
+{
+    imaging::PackedBitmap bitmap = piano_roll(400, 120);
+    std::string stored = png(bitmap, 0);
+    std::string fast = png(bitmap, 1);
+    std::string best = png(bitmap, 9);
+
+    CATCH_CHECK(same_pixels(decode(stored), bitmap));
+    CATCH_CHECK(same_pixels(decode(fast), bitmap));
+    CATCH_CHECK(same_pixels(decode(best), bitmap));
+    CATCH_CHECK(stored.size() > 400 * 120 * 3);
+    CATCH_CHECK(fast.size() * 20 < stored.size());
+    CATCH_CHECK(best.size() <= fast.size());
+}
+
+TEST_CASE("PNG, large noisy image spans several blocks and chunks")
+{
+    uint32_t state = 12345;
+    imaging::PackedBitmap bitmap(300, 200, [&state](const Position& p) {
+        state = state * 1103515245u + 12345u;
+        uint8_t noise = uint8_t(state >> 24);
+
+        return p.y % 3 == 0 ? imaging::PackedColor(noise, noise, noise) : imaging::PackedColor(uint8_t(p.x), 0, uint8_t(p.y));
+    });
+
+    for (int level : { 0, 1, 6 })
+    {
+        CATCH_CHECK(same_pixels(decode(png(bitmap, level)), bitmap));
+    }
+}
+
+TEST_CASE("PNG, rotated columns")
+{
+    imaging::PackedBitmap ring(9, 3, [](const Position& p) { return imaging::PackedColor(uint8_t(p.x * 20), uint8_t(p.y), 0); });
+    imaging::PackedBitmap rotated(9, 3, [&ring](const Position& p) { return ring[Position((p.x + 4) % 9, p.y)]; });
+    std::ostringstream out;
+    imaging::save_as_png(out, ring, 4, imaging::DEFAULT_PNG_LEVEL);
+
+    CATCH_CHECK(same_pixels(decode(out.str()), rotated));
+}
+
+TEST_CASE("PNG, color Bitmap")
+{
+    imaging::Bitmap bitmap(5, 4);
+    bitmap.fill_rect(1, 1, 3, 2, imaging::colors::cyan());
+    imaging::PackedBitmap expected(5, 4);
+    expected.fill_rect(1, 1, 3, 2, imaging::PackedColor(imaging::colors::cyan()));
+    std::ostringstream out;
+    imaging::save_as_png(out, bitmap);
+
+    CATCH_CHECK(same_pixels(decode(out.str()), expected));
+}
+
+TEST_CASE("Deflater, input split across many writes")
+{
+    std::string input;
+    for (unsigned i = 0; i != 200000; ++i)
+    {
+        input += char((i / 7) % 13 + (i % 1000 == 0 ? i / 1000 : 0));
+    }
+
+    auto compress = [&input](size_t piece) {
+        std::string result;
+        io::Deflater deflater(6, [&result](const uint8_t* data, size_t size) { result.append(reinterpret_cast<const char*>(data), size); });
+
+        for (size_t i = 0; i < input.size(); i += piece)
+        {
+            deflater.write(reinterpret_cast<const uint8_t*>(input.data()) + i, std::min(piece, input.size() - i));
+        }
+
+        deflater.finish();
+        return result;
+    };
+
+    std::string whole = compress(input.size());
+
+    CATCH_CHECK(unzlib(whole) == input);
+    CATCH_CHECK(unzlib(compress(999)) == input);
+    CATCH_CHECK(whole.size() * 10 < input.size());
+}
+
+#endif
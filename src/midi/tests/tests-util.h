@@ -37,6 +37,24 @@
 
 namespace testutils
 {
+    inline midi::NOTE note(int note_number, uint64_t start, uint64_t duration)
+    {
+        return midi::NOTE(midi::NoteNumber(note_number), midi::Time(start), midi::Duration(duration), 64, midi::Instrument(0));
+    }
+
+    // 300 overlapping notes on pitches 30 to 50, starting before time 600 and lasting less than 90
+    inline std::vector<midi::NOTE> scattered_notes()
+    {
+        std::vector<midi::NOTE> notes;
+
+        for (unsigned i = 0; i != 300; ++i)
+        {
+            notes.push_back(note(30 + (i * 11) % 21, (i * 29) % 600, (i * 7) % 90));
+        }
+
+        return notes;
+    }
+
     struct Event
     {
         midi::Duration dt;
@@ -7,6 +7,74 @@
 #include <assert.h>
 
 
+/// <summary>
+/// Non-owning, non-virtual view on a rectangle of row-major elements:
+/// row y starts at origin + y * stride. Hot loops should run on rows of a view
+/// instead of going through Grid's virtual operator[] for every element.
+/// </summary>
+template<typename T>
+class GridView final
+{
+public:
+    GridView(T* origin, size_t stride, unsigned width, unsigned height)
+        : m_origin(origin), m_stride(stride), m_width(width), m_height(height) { }
+
+    /// <summary>
+    /// A mutable view can be used where a readonly one is expected.
+    /// </summary>
+    operator GridView<const T>() const
+    {
+        return GridView<const T>(m_origin, m_stride, m_width, m_height);
+    }
+
+    T* row(unsigned y) const
+    {
+        assert(y < m_height);
+
+        return m_origin + y * m_stride;
+    }
+
+    T& operator [](const Position& p) const
+    {
+        assert(is_inside(p));
+
+        return m_origin[p.x + p.y * m_stride];
+    }
+
+    unsigned width() const
+    {
+        return m_width;
+    }
+
+    unsigned height() const
+    {
+        return m_height;
+    }
+
+    size_t stride() const
+    {
+        return m_stride;
+    }
+
+    bool is_inside(const Position& p) const
+    {
+        return p.x < m_width && p.y < m_height;
+    }
+
+    GridView subview(const Position& p, unsigned width, unsigned height) const
+    {
+        assert(p.x + width <= m_width && p.y + height <= m_height);
+
+        return GridView(m_origin + p.x + p.y * m_stride, m_stride, width, height);
+    }
+
+private:
+    T* m_origin;
+    size_t m_stride;
+    unsigned m_width;
+    unsigned m_height;
+};
+
 template<typename T>
 class Grid
 {
@@ -16,6 +84,9 @@ public:
     virtual T& operator[](const Position&) = 0;
     virtual const T& operator[](const Position&) const = 0;
 
+    virtual GridView<T> view() = 0;
+    virtual GridView<const T> view() const = 0;
+
     virtual unsigned width() const = 0;
     virtual unsigned height() const = 0;
 
@@ -86,6 +157,16 @@ public:
         return m_elts[p.x + p.y * m_width];
     }
 
+    GridView<T> view() override
+    {
+        return GridView<T>(m_elts.get(), m_width, m_width, m_height);
+    }
+
+    GridView<const T> view() const override
+    {
+        return GridView<const T>(m_elts.get(), m_width, m_width, m_height);
+    }
+
     unsigned width() const override
     {
         return m_width;
@@ -119,6 +200,16 @@ public:
         return (*m_parent)[m_position + p];
     }
 
+    GridView<T> view() override
+    {
+        return m_parent->view().subview(m_position, m_width, m_height);
+    }
+
+    GridView<const T> view() const override
+    {
+        return static_cast<const Grid<T>&>(*m_parent).view().subview(m_position, m_width, m_height);
+    }
+
     unsigned width() const override
     {
         return m_width;
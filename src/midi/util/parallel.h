@@ -0,0 +1,79 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+
+/// <summary>
+/// Number of workers to use when the caller asks for 0 (= "as many as there are cores").
+/// </summary>
+inline unsigned resolve_worker_count(unsigned requested)
+{
+    if (requested != 0)
+    {
+        return requested;
+    }
+
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/// <summary>
+/// Calls <paramref name="body" /> once for every index in [0, count), spread over
+/// <paramref name="workers" /> threads, passing along which worker (0 up to the number of
+/// threads actually used) makes the call. A worker handles its indices one at a time and in
+/// increasing order, so per-worker state can be kept without locking.
+/// Indices are handed out dynamically, so uneven work items balance out.
+/// Returns when all calls have finished.
+/// </summary>
+inline void parallel_for_workers(size_t count, unsigned workers, std::function<void(size_t, unsigned)> body)
+{
+    workers = unsigned(std::min<size_t>(resolve_worker_count(workers), count));
+
+    if (workers <= 1)
+    {
+        for (size_t i = 0; i != count; ++i)
+        {
+            body(i, 0);
+        }
+
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto work = [&next, count, &body](unsigned worker) {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            body(i, worker);
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (unsigned i = 1; i != workers; ++i)
+    {
+        threads.emplace_back(work, i);
+    }
+
+    work(0);
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+/// <summary>
+/// Calls <paramref name="body" /> once for every index in [0, count), spread over
+/// <paramref name="workers" /> threads. Indices are handed out dynamically, so uneven
+/// work items balance out. Returns when all calls have finished.
+/// </summary>
+inline void parallel_for(size_t count, unsigned workers, std::function<void(size_t)> body)
+{
+    parallel_for_workers(count, workers, [&body](size_t i, unsigned) { body(i); });
+}
+
+#endif